@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <nlohmann/json.hpp>
+
+#include "attendance-journal.hpp"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+bool syncFile(std::FILE *file)
+{
+    if (std::fflush(file) != 0)
+    {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool writeFileAtomically(const std::string &filename, std::string_view contents)
+{
+    std::string temporaryFilename = filename + ".tmp";
+    std::FILE *output = std::fopen(temporaryFilename.c_str(), "wb");
+    if (output == nullptr)
+    {
+        std::cerr << "Error: Unable to create " << temporaryFilename << std::endl;
+        return false;
+    }
+    bool written = std::fwrite(contents.data(), 1, contents.size(), output) == contents.size() && syncFile(output);
+    std::fclose(output);
+    if (!written)
+    {
+        std::cerr << "Error: Unable to write " << temporaryFilename << std::endl;
+        return false;
+    }
+
+    std::error_code error;
+    fs::rename(temporaryFilename, filename, error);
+    if (error)
+    {
+        std::cerr << "Error: Unable to replace " << filename << ": " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+AttendanceJournal::AttendanceJournal(std::string filename, std::chrono::milliseconds commitInterval)
+    : filename(std::move(filename)), commitInterval(commitInterval)
+{
+}
+
+AttendanceJournal::~AttendanceJournal()
+{
+    close();
+}
+
+std::size_t AttendanceJournal::replay(const std::string &filename, const std::function<void(const AttendanceEvent &)> &apply)
+{
+    std::ifstream input(filename);
+    if (!input.is_open())
+    {
+        return 0; // No journal, nothing to recover
+    }
+
+    std::size_t replayed = 0;
+    std::string line;
+    while (std::getline(input, line))
+    {
+        // Line structure: [date, course_and_section, mode, id, time]
+        // Parsing without exceptions, a torn line is discarded
+        json fields = json::parse(line, nullptr, false);
+        if (fields.is_discarded() || !fields.is_array() || fields.size() != 5 ||
+            !std::all_of(fields.begin(), fields.end(), [](const json &field)
+                         { return field.is_string(); }))
+        {
+            continue;
+        }
+        apply({fields[0], fields[1], fields[2], fields[3], fields[4]});
+        replayed++;
+    }
+    return replayed;
+}
+
+bool AttendanceJournal::open()
+{
+    // If the last session crashed in the middle of a line, the line is ended
+    // first so that the next event does not get appended to the torn one
+    bool tornLine = false;
+    {
+        std::ifstream input(filename, std::ios::binary | std::ios::ate);
+        if (input.is_open() && input.tellg() > 0)
+        {
+            input.seekg(-1, std::ios::end);
+            tornLine = input.get() != '\n';
+        }
+    }
+
+    file = std::fopen(filename.c_str(), "ab");
+    if (file == nullptr)
+    {
+        std::cerr << "Error: Unable to open the journal file " << filename << std::endl;
+        return false;
+    }
+    if (tornLine)
+    {
+        std::fputc('\n', file);
+    }
+
+    stopping = false;
+    commitThread = std::thread(&AttendanceJournal::commitLoop, this);
+    return true;
+}
+
+void AttendanceJournal::append(const AttendanceEvent &event)
+{
+    appendLine(json::array({event.date, event.courseAndSection, event.mode, event.id, event.time}).dump());
+}
+
+void AttendanceJournal::appendLine(std::string_view line)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pending += line;
+    pending += '\n';
+}
+
+void AttendanceJournal::commit()
+{
+    writePending();
+}
+
+bool AttendanceJournal::compact(const std::string &snapshotFilename, std::string_view snapshot)
+{
+    // Makes sure every event is either in the journal or in the snapshot
+    writePending();
+
+    if (!writeFileAtomically(snapshotFilename, snapshot))
+    {
+        return false;
+    }
+
+    // The snapshot now has every event, so the journal can start over
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (file != nullptr)
+    {
+        file = std::freopen(filename.c_str(), "wb", file);
+        if (file == nullptr)
+        {
+            std::cerr << "Error: Unable to empty the journal file " << filename << std::endl;
+            return false;
+        }
+        syncFile(file);
+    }
+    return true;
+}
+
+void AttendanceJournal::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_one();
+    if (commitThread.joinable())
+    {
+        commitThread.join();
+    }
+
+    writePending();
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (file != nullptr)
+    {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+void AttendanceJournal::commitLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping)
+    {
+        wakeUp.wait_for(lock, commitInterval);
+        if (pending.empty())
+        {
+            continue;
+        }
+
+        lock.unlock();
+        writePending();
+        lock.lock();
+    }
+}
+
+void AttendanceJournal::writePending()
+{
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+
+    // Takes the whole group of queued events at once, appending
+    // can continue while the group is being written
+    std::string group;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        group.swap(pending);
+    }
+    if (group.empty() || file == nullptr)
+    {
+        return;
+    }
+
+    if (std::fwrite(group.data(), 1, group.size(), file) != group.size() || !syncFile(file))
+    {
+        std::cerr << "Error: Unable to write to the journal file " << filename << std::endl;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// One recorded scan (see attendance-records.hpp for how scans are stored)
+struct AttendanceEvent
+{
+    std::string date;
+    std::string courseAndSection;
+    std::string mode;
+    std::string id;
+    std::string time;
+};
+
+// Append-only log of the scans recorded since the last snapshot (backup.bin)
+//
+// Each scan is appended as one line, and a background thread writes the
+// pending lines and syncs them to the disk every `commitInterval` (group
+// commit), so the cost of persisting a scan does not depend on how much
+// attendance history there is. On startup the journal of a session that did
+// not exit cleanly is replayed on top of the snapshot, and on exit the
+// snapshot is rewritten once and the journal is emptied (compaction)
+class AttendanceJournal
+{
+public:
+    explicit AttendanceJournal(std::string filename, std::chrono::milliseconds commitInterval = std::chrono::milliseconds(200));
+    ~AttendanceJournal();
+
+    AttendanceJournal(const AttendanceJournal &) = delete;
+    AttendanceJournal &operator=(const AttendanceJournal &) = delete;
+
+    // Calls `apply` for every complete event in the journal file, in the order
+    // they were recorded. A torn last line (from a crash during a write) is
+    // ignored. Returns the number of events replayed
+    static std::size_t replay(const std::string &filename, const std::function<void(const AttendanceEvent &)> &apply);
+
+    // Opens the journal for appending and starts the group commit thread
+    bool open();
+
+    // Queues the event for the next group commit
+    void append(const AttendanceEvent &event);
+
+    // Queues a line of another format (see event-log.hpp), without the newline
+    void appendLine(std::string_view line);
+
+    // Writes and syncs the queued events right away
+    void commit();
+
+    // Atomically replaces `snapshotFilename` with the `snapshot` bytes, then
+    // empties the journal. If the program stops in between, the replayed
+    // events are already in the snapshot, which is harmless since a scan is
+    // only recorded once per date/section/mode/ID
+    bool compact(const std::string &snapshotFilename, std::string_view snapshot);
+
+    // Commits the queued events and stops the group commit thread
+    void close();
+
+private:
+    void commitLoop();
+    void writePending();
+
+    std::string filename;
+    std::chrono::milliseconds commitInterval;
+
+    std::FILE *file = nullptr;
+    std::string pending;
+
+    // `mutex` guards `pending` and `stopping`, `fileMutex` serializes the
+    // writes so that appending never waits for the disk
+    std::mutex mutex;
+    std::mutex fileMutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+    std::thread commitThread;
+};
+
+// Flushes the stream and asks the operating system to write it to the disk
+bool syncFile(std::FILE *file);
+
+// Writes `contents` to a temporary file, syncs it, then renames it over
+// `filename`, so that a crash never leaves a half written file
+bool writeFileAtomically(const std::string &filename, std::string_view contents);
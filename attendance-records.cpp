@@ -0,0 +1,372 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+#include "attendance-records.hpp"
+#include "utils.hpp"
+
+using json = nlohmann::json;
+
+static const char magic[4] = {'Q', 'R', 'A', 'B'};
+
+bool AttendanceRecords::add(const AttendanceEvent &event)
+{
+    std::uint16_t minutes;
+    if (!parseClockTime(event.time, minutes))
+    {
+        return false;
+    }
+
+    // Looks the keys up without interning them, a repeated scan adds nothing
+    AttendanceRecord record{strings.find(event.date), strings.find(event.courseAndSection),
+                            strings.find(event.mode), strings.find(event.id), minutes};
+    if (record.date != StringInterner::noSymbol && record.courseAndSection != StringInterner::noSymbol &&
+        record.mode != StringInterner::noSymbol && record.id != StringInterner::noSymbol &&
+        !slots.empty() && slots[slotOf(record)] != emptySlot)
+    {
+        return false;
+    }
+
+    record.date = strings.intern(event.date);
+    record.courseAndSection = strings.intern(event.courseAndSection);
+    record.mode = strings.intern(event.mode);
+    record.id = strings.intern(event.id);
+    insert(record);
+    return true;
+}
+
+std::size_t AttendanceRecords::size() const
+{
+    return recordList.size();
+}
+
+const std::vector<AttendanceRecord> &AttendanceRecords::records() const
+{
+    return recordList;
+}
+
+const std::vector<StringInterner::Symbol> &AttendanceRecords::dates() const
+{
+    return dateList;
+}
+
+std::string_view AttendanceRecords::text(StringInterner::Symbol symbol) const
+{
+    return strings.view(symbol);
+}
+
+AttendanceEvent AttendanceRecords::event(const AttendanceRecord &record) const
+{
+    return AttendanceEvent{std::string(text(record.date)), std::string(text(record.courseAndSection)),
+                           std::string(text(record.mode)), std::string(text(record.id)), formatClockTime(record.minutes)};
+}
+
+AttendanceRecords AttendanceRecords::fromJson(const json &backupData)
+{
+    AttendanceRecords records;
+    if (!backupData.contains("attendance"))
+    {
+        return records;
+    }
+
+    for (auto &recordsByDate : backupData["attendance"].items())
+    {
+        for (auto &recordsBySection : recordsByDate.value().items())
+        {
+            for (auto &recordsByMode : recordsBySection.value().items())
+            {
+                for (auto &recordsByID : recordsByMode.value().items())
+                {
+                    if (!recordsByID.value().is_string())
+                    {
+                        continue;
+                    }
+                    records.add({recordsByDate.key(), recordsBySection.key(), recordsByMode.key(),
+                                 recordsByID.key(), recordsByID.value().get<std::string>()});
+                }
+            }
+        }
+    }
+    return records;
+}
+
+json AttendanceRecords::toJson() const
+{
+    json backupData = {{"attendance", json::object()}};
+    json &attendance = backupData["attendance"];
+    for (const auto &record : recordList)
+    {
+        attendance[std::string(text(record.date))][std::string(text(record.courseAndSection))]
+                  [std::string(text(record.mode))][std::string(text(record.id))] = formatClockTime(record.minutes);
+    }
+    return backupData;
+}
+
+static void putU16(std::string &output, std::uint16_t value)
+{
+    output += static_cast<char>(value & 0xff);
+    output += static_cast<char>(value >> 8);
+}
+
+static void putU32(std::string &output, std::uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        output += static_cast<char>((value >> shift) & 0xff);
+    }
+}
+
+static void putU64(std::string &output, std::uint64_t value)
+{
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        output += static_cast<char>((value >> shift) & 0xff);
+    }
+}
+
+std::string AttendanceRecords::serialize() const
+{
+    std::size_t stringBytes = 0;
+    for (StringInterner::Symbol symbol = 0; symbol < strings.size(); ++symbol)
+    {
+        stringBytes += 4 + text(symbol).size();
+    }
+
+    std::string output;
+    output.reserve(4 + 4 + 4 + stringBytes + 4 + recordList.size() * 18 + 8);
+
+    output.append(magic, sizeof(magic));
+    putU32(output, formatVersion);
+
+    putU32(output, static_cast<std::uint32_t>(strings.size()));
+    for (StringInterner::Symbol symbol = 0; symbol < strings.size(); ++symbol)
+    {
+        std::string_view string = text(symbol);
+        putU32(output, static_cast<std::uint32_t>(string.size()));
+        output.append(string.data(), string.size());
+    }
+
+    putU32(output, static_cast<std::uint32_t>(recordList.size()));
+    for (const auto &record : recordList)
+    {
+        putU32(output, record.date);
+        putU32(output, record.courseAndSection);
+        putU32(output, record.mode);
+        putU32(output, record.id);
+        putU16(output, record.minutes);
+    }
+
+    putU64(output, fnv1aHash(output));
+    return output;
+}
+
+// Reads little-endian integers from the snapshot, failing once past its end
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader(std::string_view data)
+        : data(data)
+    {
+    }
+
+    bool read(std::uint64_t &value, int bytes)
+    {
+        if (data.size() - position < static_cast<std::size_t>(bytes))
+        {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < bytes; ++i)
+        {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[position + i])) << (8 * i);
+        }
+        position += bytes;
+        return true;
+    }
+
+    bool readU16(std::uint16_t &value)
+    {
+        std::uint64_t wide;
+        bool ok = read(wide, 2);
+        value = static_cast<std::uint16_t>(wide);
+        return ok;
+    }
+
+    bool readU32(std::uint32_t &value)
+    {
+        std::uint64_t wide;
+        bool ok = read(wide, 4);
+        value = static_cast<std::uint32_t>(wide);
+        return ok;
+    }
+
+    bool readBytes(std::string_view &bytes, std::size_t length)
+    {
+        if (data.size() - position < length)
+        {
+            return false;
+        }
+        bytes = data.substr(position, length);
+        position += length;
+        return true;
+    }
+
+private:
+    std::string_view data;
+    std::size_t position = 0;
+};
+
+bool AttendanceRecords::deserialize(std::string_view data, AttendanceRecords &records)
+{
+    records = AttendanceRecords();
+
+    // The checksum covers everything before it
+    if (data.size() < sizeof(magic) + 8 || std::memcmp(data.data(), magic, sizeof(magic)) != 0)
+    {
+        return false;
+    }
+    std::string_view payload = data.substr(0, data.size() - 8);
+    std::uint64_t checksum;
+    SnapshotReader checksumReader(data.substr(payload.size()));
+    if (!checksumReader.read(checksum, 8) || checksum != fnv1aHash(payload))
+    {
+        return false;
+    }
+
+    SnapshotReader reader(payload.substr(sizeof(magic)));
+    std::uint32_t version, stringsNum, recordsNum;
+    if (!reader.readU32(version) || version != formatVersion || !reader.readU32(stringsNum))
+    {
+        return false;
+    }
+
+    AttendanceRecords decoded;
+    for (std::uint32_t i = 0; i < stringsNum; ++i)
+    {
+        std::uint32_t length;
+        std::string_view string;
+        if (!reader.readU32(length) || !reader.readBytes(string, length) || decoded.strings.intern(string) != i)
+        {
+            return false; // Truncated, or the same string twice
+        }
+    }
+
+    if (!reader.readU32(recordsNum))
+    {
+        return false;
+    }
+    decoded.recordList.reserve(recordsNum);
+    for (std::uint32_t i = 0; i < recordsNum; ++i)
+    {
+        AttendanceRecord record;
+        if (!reader.readU32(record.date) || !reader.readU32(record.courseAndSection) ||
+            !reader.readU32(record.mode) || !reader.readU32(record.id) || !reader.readU16(record.minutes))
+        {
+            return false;
+        }
+        // Times past 23:59 are rejected, as parseClockTime does for the scans and backup.json
+        if (record.date >= stringsNum || record.courseAndSection >= stringsNum ||
+            record.mode >= stringsNum || record.id >= stringsNum || record.minutes >= 24 * 60)
+        {
+            return false;
+        }
+        if (decoded.slots.empty() || decoded.slots[decoded.slotOf(record)] == emptySlot)
+        {
+            decoded.insert(record);
+        }
+    }
+
+    records = std::move(decoded);
+    return true;
+}
+
+void AttendanceRecords::insert(const AttendanceRecord &record)
+{
+    // Keeps the table at most half full
+    if ((recordList.size() + 1) * 2 > slots.size())
+    {
+        grow();
+    }
+
+    if (record.date >= listedDates.size())
+    {
+        listedDates.resize(strings.size(), false);
+    }
+    if (!listedDates[record.date])
+    {
+        listedDates[record.date] = true;
+        dateList.push_back(record.date);
+    }
+
+    slots[slotOf(record)] = static_cast<std::uint32_t>(recordList.size());
+    recordList.push_back(record);
+}
+
+// Returns the slot of the record with the same keys, or the empty slot where it belongs
+std::size_t AttendanceRecords::slotOf(const AttendanceRecord &record) const
+{
+    std::uint64_t hash = (static_cast<std::uint64_t>(record.date) * 0x9E3779B97F4A7C15ull) ^
+                         (static_cast<std::uint64_t>(record.courseAndSection) * 0xC2B2AE3D27D4EB4Full) ^
+                         (static_cast<std::uint64_t>(record.mode) * 0x165667B19E3779F9ull) ^
+                         (static_cast<std::uint64_t>(record.id) * 0xD6E8FEB86659FD93ull);
+    hash ^= hash >> 29;
+
+    std::size_t mask = slots.size() - 1;
+    std::size_t slot = static_cast<std::size_t>(hash) & mask;
+    while (slots[slot] != emptySlot)
+    {
+        const AttendanceRecord &other = recordList[slots[slot]];
+        if (other.date == record.date && other.courseAndSection == record.courseAndSection &&
+            other.mode == record.mode && other.id == record.id)
+        {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void AttendanceRecords::grow()
+{
+    std::size_t capacity = slots.empty() ? 64 : slots.size() * 2;
+    slots.assign(capacity, emptySlot);
+    for (std::size_t i = 0; i < recordList.size(); ++i)
+    {
+        slots[slotOf(recordList[i])] = static_cast<std::uint32_t>(i);
+    }
+}
+
+bool parseClockTime(std::string_view text, std::uint16_t &minutes)
+{
+    // "H:MM" or "HH:MM"
+    std::size_t colon = text.find(':');
+    if (colon == std::string_view::npos || colon == 0 || colon > 2 || text.size() != colon + 3)
+    {
+        return false;
+    }
+    int hours = 0;
+    for (std::size_t i = 0; i < colon; ++i)
+    {
+        if (text[i] < '0' || text[i] > '9')
+        {
+            return false;
+        }
+        hours = hours * 10 + (text[i] - '0');
+    }
+    if (text[colon + 1] < '0' || text[colon + 1] > '5' || text[colon + 2] < '0' || text[colon + 2] > '9' || hours > 23)
+    {
+        return false;
+    }
+    minutes = static_cast<std::uint16_t>(hours * 60 + (text[colon + 1] - '0') * 10 + (text[colon + 2] - '0'));
+    return true;
+}
+
+std::string formatClockTime(std::uint16_t minutes)
+{
+    char text[6];
+    std::snprintf(text, sizeof(text), "%02d:%02d", (minutes / 60) % 100, minutes % 60);
+    return text;
+}
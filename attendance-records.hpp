@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "attendance-journal.hpp"
+#include "string-interner.hpp"
+
+// One recorded scan. The keys are symbols of the records' string pool and
+// the time is packed as minutes since midnight
+struct AttendanceRecord
+{
+    StringInterner::Symbol date;
+    StringInterner::Symbol courseAndSection;
+    StringInterner::Symbol mode;
+    StringInterner::Symbol id;
+    std::uint16_t minutes;
+};
+
+// Every scan of the attendance data, one fixed-size record per scan in a
+// contiguous array, instead of a tree of JSON objects keyed by strings.
+// The dates, sections, modes and IDs are interned, and the records are
+// indexed by their keys in an open-addressing hash table, so a scan is
+// recorded once per date/section/mode/ID
+//
+// Binary format (little-endian), version 1:
+//      "QRAB"              magic
+//      u32                 version
+//      u32                 number of strings, then for each: u32 length, bytes
+//      u32                 number of records, then for each:
+//                          u32 date, u32 course and section, u32 mode, u32 id (string numbers), u16 minutes
+//      u64                 FNV-1a hash of everything before it
+class AttendanceRecords
+{
+public:
+    static constexpr std::uint32_t formatVersion = 1;
+
+    // Stores the scan unless it is already recorded. Returns true if stored,
+    // false if already recorded or if the time is not a valid "HH:MM"
+    bool add(const AttendanceEvent &event);
+
+    std::size_t size() const;
+
+    const std::vector<AttendanceRecord> &records() const;
+
+    // Dates in the order they were first recorded
+    const std::vector<StringInterner::Symbol> &dates() const;
+
+    // The returned view stays valid until the next call to `add`
+    std::string_view text(StringInterner::Symbol symbol) const;
+
+    AttendanceEvent event(const AttendanceRecord &record) const;
+
+    // Converts from/to the structure of backup.json
+    //      { attendance: { [date]: { [course_and_section]: { [mode]: { [id]: [time] } } } } }
+    // Records with an invalid time are skipped by `fromJson`
+    static AttendanceRecords fromJson(const nlohmann::json &backupData);
+    nlohmann::json toJson() const;
+
+    // Encodes the records in the binary format
+    std::string serialize() const;
+
+    // Decodes the binary format. Returns false if the data is not a valid
+    // snapshot of a supported version (`records` is then left empty)
+    static bool deserialize(std::string_view data, AttendanceRecords &records);
+
+private:
+    void insert(const AttendanceRecord &record);
+    std::size_t slotOf(const AttendanceRecord &record) const;
+    void grow();
+
+    static constexpr std::uint32_t emptySlot = UINT32_MAX;
+
+    StringInterner strings;
+    std::vector<AttendanceRecord> recordList;
+    std::vector<StringInterner::Symbol> dateList;
+
+    // Whether each symbol is in `dateList`
+    std::vector<bool> listedDates;
+
+    // Open-addressing (linear probing) table of record indices keyed by
+    // date/section/mode/ID, the size is a power of two
+    std::vector<std::uint32_t> slots;
+};
+
+// "HH:MM" <-> minutes since midnight. Returns false if `text` is not a valid time
+bool parseClockTime(std::string_view text, std::uint16_t &minutes);
+std::string formatClockTime(std::uint16_t minutes);
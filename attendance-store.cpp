@@ -0,0 +1,113 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "attendance-store.hpp"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+const std::vector<std::string> &attendanceModes()
+{
+    static const std::vector<std::string> modes =
+        {"AM Time In", "AM Time Out", "PM Time In", "PM Time Out"};
+    return modes;
+}
+
+AttendanceStore::AttendanceStore(std::string snapshotFilename, std::string journalFilename, std::string legacyFilename)
+    : snapshotFilename(std::move(snapshotFilename)), journalFilename(journalFilename),
+      legacyFilename(std::move(legacyFilename)), journal(journalFilename)
+{
+}
+
+bool AttendanceStore::open()
+{
+    if (fs::exists(snapshotFilename))
+    {
+        std::ifstream input(snapshotFilename, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        if (!AttendanceRecords::deserialize(data, records))
+        {
+            std::cerr << "Error: " << snapshotFilename << " is damaged or was written by a newer version." << std::endl;
+            return false;
+        }
+    }
+    else
+    {
+        if (!legacyFilename.empty() && fs::exists(legacyFilename))
+        {
+            std::ifstream f(legacyFilename);
+            try
+            {
+                records = AttendanceRecords::fromJson(json::parse(f));
+            }
+            catch (const json::exception &e)
+            {
+                std::cerr << "Error: Unable to read " << legacyFilename << ": " << e.what() << std::endl;
+                return false;
+            }
+            importedNum = records.size();
+        }
+
+        // Creates the snapshot right away, so that a location that cannot be
+        // written to is reported before any scan
+        if (!writeFileAtomically(snapshotFilename, records.serialize()))
+        {
+            return false;
+        }
+    }
+
+    // The journal holds the scans recorded since the snapshot was last written.
+    // If the previous session did not exit cleanly, its scans are recovered
+    recoveredNum = AttendanceJournal::replay(journalFilename, [this](const AttendanceEvent &event)
+                                             { records.add(event); });
+
+    return journal.open();
+}
+
+std::size_t AttendanceStore::importedScans() const
+{
+    return importedNum;
+}
+
+std::size_t AttendanceStore::recoveredScans() const
+{
+    return recoveredNum;
+}
+
+bool AttendanceStore::record(const AttendanceEvent &event)
+{
+    if (!records.add(event))
+    {
+        return false;
+    }
+    journal.append(event);
+    return true;
+}
+
+bool AttendanceStore::save()
+{
+    return journal.compact(snapshotFilename, records.serialize());
+}
+
+bool AttendanceStore::exportJson(const std::string &filename) const
+{
+    std::string text = records.toJson().dump(4);
+    text += '\n';
+    return writeFileAtomically(filename, text);
+}
+
+void AttendanceStore::close()
+{
+    journal.close();
+}
+
+const AttendanceRecords &AttendanceStore::data() const
+{
+    return records;
+}
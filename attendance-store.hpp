@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "attendance-journal.hpp"
+#include "attendance-records.hpp"
+
+// The four attendance modes, in the order of their columns on the sheets
+const std::vector<std::string> &attendanceModes();
+
+// The attendance data of a station: the binary snapshot (backup.bin, see
+// attendance-records.hpp) and the journal of the scans recorded since the
+// snapshot was written (see attendance-journal.hpp)
+class AttendanceStore
+{
+public:
+    // `legacyFilename` is the JSON backup (backup.json) of older versions,
+    // imported when there is no snapshot yet
+    AttendanceStore(std::string snapshotFilename, std::string journalFilename, std::string legacyFilename = "");
+
+    AttendanceStore(const AttendanceStore &) = delete;
+    AttendanceStore &operator=(const AttendanceStore &) = delete;
+
+    // Loads the snapshot (importing the JSON backup or creating an empty
+    // snapshot if missing), replays the journal of a session that did not
+    // exit cleanly, and opens the journal for the new scans
+    // Returns false if a file could not be read or created
+    bool open();
+
+    // Number of scans imported from the JSON backup by `open`
+    std::size_t importedScans() const;
+
+    // Number of scans recovered from the journal by `open`
+    std::size_t recoveredScans() const;
+
+    // Stores the scan and appends it to the journal, unless the student was
+    // already recorded for that date and mode. Returns true if it was stored
+    // Not thread-safe, scans are recorded from a single thread
+    bool record(const AttendanceEvent &event);
+
+    // Rewrites the snapshot with every scan and empties the journal
+    bool save();
+
+    // Writes every scan in the structure of backup.json
+    bool exportJson(const std::string &filename) const;
+
+    // Commits the pending scans to the journal and closes it
+    void close();
+
+    const AttendanceRecords &data() const;
+
+private:
+    std::string snapshotFilename;
+    std::string journalFilename;
+    std::string legacyFilename;
+    AttendanceJournal journal;
+    AttendanceRecords records;
+    std::size_t importedNum = 0;
+    std::size_t recoveredNum = 0;
+};
@@ -0,0 +1,164 @@
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include "ReadBarcode.h"
+#include "DecodeHints.h"
+
+#include "utils.hpp"
+#include "frame-source.hpp"
+#include "roi-tracker.hpp"
+#include "scanner-config.hpp"
+
+namespace fs = std::filesystem;
+
+// One decoder profile to be measured
+struct DecodeProfile
+{
+    std::string name;
+    ScannerConfig config;
+};
+
+struct ProfileResult
+{
+    double milliseconds = 0;
+    std::size_t framesWithCodes = 0;
+    std::set<std::string> distinctIDs;
+};
+
+// Decodes every frame in order, like a station would, with the profile's
+// hints and ROI settings. The frames are already in memory, so only the
+// decoding is timed
+static ProfileResult runProfile(const DecodeProfile &profile, const std::vector<cv::Mat> &frames, int repeat)
+{
+    ZXing::DecodeHints hints = buildDecodeHints(profile.config);
+
+    ProfileResult result;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < repeat; ++round)
+    {
+        RoiTracker tracker(profile.config.pipeline.roi);
+        for (const cv::Mat &frame : frames)
+        {
+            TrackedResults tracked = tracker.decode(frame, hints);
+            if (round != 0)
+            {
+                continue;
+            }
+            if (!tracked.results.empty())
+            {
+                result.framesWithCodes++;
+            }
+            for (const auto &r : tracked.results)
+            {
+                result.distinctIDs.insert(r.text());
+            }
+        }
+    }
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    // Usage: qrar-decode-bench [--frames DIR] [--repeat N] [profile.json ...]
+    //      --frames    directory of captured frames (png/jpg), decoded in name order (default: bench-frames)
+    //      --repeat    number of times the frames are decoded (default: 3)
+    //      profiles    scanner configurations to compare (see scanner-config.hpp)
+    //
+    // Besides the given profiles, the built-in defaults and the old
+    // "every format" setting are always measured, as references
+    std::string framesDirectory = getOptionValue(argc, argv, "--frames", "bench-frames");
+    int repeat;
+    try
+    {
+        repeat = std::max(1, std::stoi(getOptionValue(argc, argv, "--repeat", "3")));
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << "Invalid option value, expected a number." << std::endl;
+        return 1;
+    }
+
+    std::vector<DecodeProfile> profiles;
+    DecodeProfile anyFormat{"any-format", ScannerConfig()};
+    anyFormat.config.formats = ""; // No format restriction
+    profiles.push_back(anyFormat);
+    profiles.push_back({"default", ScannerConfig()});
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (argument == "--frames" || argument == "--repeat")
+        {
+            ++i; // Skips the option's value
+            continue;
+        }
+        if (!fs::exists(argument))
+        {
+            std::cerr << "Profile not found: " << argument << std::endl;
+            return 1;
+        }
+        try
+        {
+            profiles.push_back({fs::path(argument).stem().string(), loadScannerConfig(argument)});
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!fs::is_directory(framesDirectory))
+    {
+        std::cerr << "Frames directory not found: " << framesDirectory << std::endl;
+        return 1;
+    }
+
+    std::vector<cv::Mat> frames;
+    ImageDirectorySource frameSource(framesDirectory);
+    cv::Mat frame;
+    while (frameSource.next(frame))
+    {
+        frames.push_back(frame);
+    }
+    if (frames.empty())
+    {
+        std::cerr << "No frames could be read from " << framesDirectory << std::endl;
+        return 1;
+    }
+
+    std::cout << "Decoding " << frames.size() << " frames " << repeat << " time(s) per profile.\n"
+              << std::endl;
+    std::cout << std::left << std::setw(20) << "profile" << std::right
+              << std::setw(12) << "ms/frame" << std::setw(12) << "frames/s"
+              << std::setw(10) << "found" << std::setw(8) << "IDs" << std::endl;
+
+    for (const DecodeProfile &profile : profiles)
+    {
+        ProfileResult result;
+        try
+        {
+            result = runProfile(profile, frames, repeat);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << profile.name << ": " << e.what() << std::endl;
+            continue;
+        }
+
+        double perFrame = result.milliseconds / (static_cast<double>(frames.size()) * repeat);
+        std::cout << std::left << std::setw(20) << profile.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << perFrame << std::setw(12) << (perFrame > 0 ? 1000.0 / perFrame : 0.0)
+                  << std::setw(10) << result.framesWithCodes << std::setw(8) << result.distinctIDs.size() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include <nlohmann/json.hpp>
+
+#include "event-log.hpp"
+
+using json = nlohmann::json;
+
+EventLog::EventLog(std::string filename, std::string station)
+    : station(std::move(station)), journal(std::move(filename))
+{
+}
+
+bool EventLog::open()
+{
+    return journal.open();
+}
+
+void EventLog::append(const AttendanceEvent &event)
+{
+    std::int64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::system_clock::now().time_since_epoch())
+                                 .count();
+    journal.appendLine(json::array({timestamp, station, event.date, event.courseAndSection, event.mode, event.id, event.time}).dump());
+}
+
+void EventLog::close()
+{
+    journal.close();
+}
+
+bool EventLogReader::open(const std::string &filename)
+{
+    input.open(filename);
+    skippedNum = 0;
+    return input.is_open();
+}
+
+bool EventLogReader::next(StationEvent &stationEvent)
+{
+    while (std::getline(input, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+
+        // Parsing without exceptions, an invalid line is skipped
+        json fields = json::parse(line, nullptr, false);
+        if (fields.is_discarded() || !fields.is_array() || fields.size() != 7 || !fields[0].is_number_integer())
+        {
+            skippedNum++;
+            continue;
+        }
+        bool allStrings = true;
+        for (std::size_t i = 1; i < fields.size(); ++i)
+        {
+            allStrings = allStrings && fields[i].is_string();
+        }
+        if (!allStrings)
+        {
+            skippedNum++;
+            continue;
+        }
+
+        stationEvent.timestamp = fields[0].get<std::int64_t>();
+        stationEvent.station = fields[1].get<std::string>();
+        stationEvent.event = AttendanceEvent{fields[2], fields[3], fields[4], fields[5], fields[6]};
+        return true;
+    }
+    return false;
+}
+
+std::size_t EventLogReader::skippedLines() const
+{
+    return skippedNum;
+}
+
+std::string eventLogFilename(const std::string &station)
+{
+    std::string name = station;
+    for (char &c : name)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_')
+        {
+            c = '_';
+        }
+    }
+    return "events-" + name + ".log";
+}
+
+std::string defaultStationName()
+{
+#ifdef _WIN32
+    const char *computerName = std::getenv("COMPUTERNAME");
+    if (computerName != nullptr && *computerName != '\0')
+    {
+        return computerName;
+    }
+#else
+    char hostName[256] = {};
+    if (gethostname(hostName, sizeof(hostName) - 1) == 0 && hostName[0] != '\0')
+    {
+        return hostName;
+    }
+#endif
+    return "qrar";
+}
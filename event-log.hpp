@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "attendance-journal.hpp"
+
+// A scan as recorded by one station, with the time it was recorded at
+struct StationEvent
+{
+    // Milliseconds since the Unix epoch (UTC), to order the scans of all stations
+    std::int64_t timestamp;
+    std::string station;
+    AttendanceEvent event;
+};
+
+// Append-only log of every scan a station has recorded (ex.
+// "events-GATE1.log"), never emptied, unlike the journal. The logs of
+// several stations are merged into one attendance data by qrar-merge
+//
+// Each scan is one line, appended with the group commit of the journal:
+//      [timestamp, station, date, course_and_section, mode, id, time]
+class EventLog
+{
+public:
+    EventLog(std::string filename, std::string station);
+
+    bool open();
+
+    // Queues the scan, timestamped with the current time
+    void append(const AttendanceEvent &event);
+
+    void close();
+
+private:
+    std::string station;
+    AttendanceJournal journal;
+};
+
+// Reads an event log from the start, one event at a time
+class EventLogReader
+{
+public:
+    bool open(const std::string &filename);
+
+    // Reads the next event. Returns false at the end of the log. Lines that
+    // are not valid events (ex. torn by a crash) are skipped and counted
+    bool next(StationEvent &stationEvent);
+
+    std::size_t skippedLines() const;
+
+private:
+    std::ifstream input;
+    std::string line;
+    std::size_t skippedNum = 0;
+};
+
+// The name of the event log of a station ("events-[station].log"). The
+// characters of the station name that may not be valid in a filename are
+// replaced by '_'
+std::string eventLogFilename(const std::string &station);
+
+// The name of this computer (COMPUTERNAME on Windows, gethostname elsewhere), or "qrar" if unknown
+std::string defaultStationName();
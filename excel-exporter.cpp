@@ -0,0 +1,421 @@
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <OpenXLSX.hpp>
+
+#include "utils.hpp"
+#include "excel-exporter.hpp"
+#include "thread-pool.hpp"
+#include "xlsx-stream-writer.hpp"
+
+using namespace OpenXLSX;
+namespace fs = std::filesystem;
+
+ExcelExporter::ExcelExporter(const Roster &roster, std::vector<std::string> modes)
+    : roster(roster), modes(std::move(modes))
+{
+}
+
+void ExcelExporter::open(const std::string &filename)
+{
+    mark = ExportMark(filename);
+    if (fs::exists(filename))
+    {
+        mark.load();
+        doc.open(filename);
+        modified = false;
+    }
+    else
+    {
+        doc.create(filename);
+        modified = true;
+    }
+    catalog.load(doc);
+    pending.clear();
+}
+
+// Indices of the given records of each section, in the order they were recorded
+static std::unordered_map<std::string_view, std::vector<std::size_t>> groupBySection(const AttendanceRecords &records, const std::vector<std::size_t> &indices)
+{
+    std::unordered_map<std::string_view, std::vector<std::size_t>> recordsBySection;
+    const std::vector<AttendanceRecord> &recordList = records.records();
+    for (std::size_t index : indices)
+    {
+        recordsBySection[records.text(recordList[index].courseAndSection)].push_back(index);
+    }
+    return recordsBySection;
+}
+
+std::vector<std::string> ExcelExporter::writeHeaders(const AttendanceRecords &records)
+{
+    const std::vector<AttendanceRecord> &recordList = records.records();
+    pending = mark.pending(records);
+
+    // Detects the students of the attendance data that are not registered,
+    // and the dates of the records to write
+    std::vector<std::string> unregisteredIDs;
+    std::unordered_set<StringInterner::Symbol> checkedIDs;
+    std::unordered_set<StringInterner::Symbol> pendingDates;
+    for (std::size_t index : pending)
+    {
+        const AttendanceRecord &record = recordList[index];
+        if (checkedIDs.insert(record.id).second && roster.find(records.text(record.id)) == nullptr)
+        {
+            unregisteredIDs.emplace_back(records.text(record.id));
+        }
+        pendingDates.insert(record.date);
+    }
+
+    auto recordsBySection = groupBySection(records, pending);
+
+    for (const auto &section : roster.sections())
+    {
+        // Creates the sheet only if it doesn't exists, otherwise uses it
+        bool newSheet = catalog.addSheet(section);
+        modified = modified || newSheet;
+
+        // Nothing to add to a sheet that was already written, if no record
+        // is pending (a new date is added to every sheet)
+        if (!newSheet && pendingDates.empty())
+        {
+            continue;
+        }
+        XLWorksheet &wks = catalog.worksheet(section);
+
+        // The headers already written on the excel file are read once by the
+        // catalog. The index is kept up to date as headers are added, and
+        // reused by writeTimes
+        SheetIndex &sheetIndex = catalog.index(section);
+
+        // Writes the dates not already written to the column headers (row 3),
+        // in the order they were first recorded
+        for (auto dateSymbol : records.dates())
+        {
+            std::string date(records.text(dateSymbol));
+            if (!sheetIndex.hasDate(date))
+            {
+                sheetIndex.addDate(wks, date, modes);
+                modified = true;
+            }
+        }
+
+        auto sectionRecords = recordsBySection.find(section);
+        if (sectionRecords == recordsBySection.end())
+        {
+            continue;
+        }
+
+        // Writes the IDs and names not already written to the IDs/names headers (columns 1 and 2 respectively)
+        for (std::size_t index : sectionRecords->second)
+        {
+            std::string id(records.text(recordList[index].id));
+            const StudentRecord *student = roster.find(id);
+
+            // Writes the student to the sheet if the student is
+            // a student of the current section
+            if (student != nullptr && roster.courseAndSection(*student) == section && !sheetIndex.hasStudent(id))
+            {
+                sheetIndex.addStudent(wks, id, std::string(roster.name(*student)));
+                modified = true;
+            }
+        }
+    }
+
+    return unregisteredIDs;
+}
+
+std::size_t ExcelExporter::pendingRecords() const
+{
+    return pending.size();
+}
+
+bool ExcelExporter::writeTimes(const AttendanceRecords &records)
+{
+    const std::vector<AttendanceRecord> &recordList = records.records();
+
+    // Position of each mode's column within a date
+    std::unordered_map<StringInterner::Symbol, int> modeOffsets;
+
+    for (const auto &[section, indices] : groupBySection(records, pending))
+    {
+        std::string sheetName(section);
+        if (!catalog.hasSheet(sheetName))
+        {
+            std::cerr << "ERROR: Could not find the sheet of the section " << section << std::endl;
+            return false;
+        }
+        const SheetIndex &sheetIndex = catalog.index(sheetName);
+
+        // Open worksheet
+        XLWorksheet &wks = catalog.worksheet(sheetName);
+        wks.setActive();
+
+        // First column of each date on this sheet
+        std::unordered_map<StringInterner::Symbol, int> dateColumns;
+
+        for (std::size_t index : indices)
+        {
+            const AttendanceRecord &record = recordList[index];
+
+            // Finds the column index to where the time info shall be placed for the student
+            auto dateColumn = dateColumns.find(record.date);
+            if (dateColumn == dateColumns.end())
+            {
+                dateColumn = dateColumns.emplace(record.date, sheetIndex.dateColumn(std::string(records.text(record.date)))).first;
+            }
+            if (dateColumn->second == -1)
+            {
+                std::cerr << "ERROR: Could not find the corresponding column coordinate for date " << records.text(record.date) << std::endl;
+                return false;
+            }
+
+            // Finds the appropriate column based on the mode
+            auto modeOffset = modeOffsets.find(record.mode);
+            if (modeOffset == modeOffsets.end())
+            {
+                modeOffset = modeOffsets.emplace(record.mode, findIndex(modes, std::string(records.text(record.mode)))).first;
+            }
+            if (modeOffset->second == -1)
+            {
+                std::cerr << "ERROR: Unknown mode " << records.text(record.mode) << std::endl;
+                return false;
+            }
+
+            // Finds the row index to where the time info shall be placed for the student
+            int rowIndex = sheetIndex.studentRow(std::string(records.text(record.id)));
+            if (rowIndex == -1)
+            {
+                std::cerr << "ERROR: Could not find the corresponding row coordinate of the student " << records.text(record.id) << std::endl;
+                return false;
+            }
+
+            // Stores the time info to the target cell
+            wks.cell(XLCellReference(rowIndex, dateColumn->second + modeOffset->second)).value() = formatClockTime(record.minutes);
+            modified = true;
+        }
+    }
+
+    mark.markExported(records);
+    pending.clear();
+    return true;
+}
+
+void ExcelExporter::save()
+{
+    // A large workbook takes long to save, it is skipped if unchanged
+    if (modified)
+    {
+        doc.save();
+        modified = false;
+    }
+    mark.save();
+}
+
+void ExcelExporter::close()
+{
+    doc.close();
+}
+
+std::vector<std::string> ExcelExporter::findUnregisteredIDs(const AttendanceRecords &records) const
+{
+    std::vector<std::string> unregisteredIDs;
+    std::unordered_set<StringInterner::Symbol> checkedIDs;
+    for (const auto &record : records.records())
+    {
+        if (checkedIDs.insert(record.id).second && roster.find(records.text(record.id)) == nullptr)
+        {
+            unregisteredIDs.emplace_back(records.text(record.id));
+        }
+    }
+    return unregisteredIDs;
+}
+
+bool ExcelExporter::rebuild(const std::string &filename, const AttendanceRecords &records)
+{
+    const std::vector<AttendanceRecord> &recordList = records.records();
+    int modesNum = static_cast<int>(modes.size());
+
+    // First column of each date, in the order they were first recorded
+    std::unordered_map<StringInterner::Symbol, int> dateColumns;
+    for (auto dateSymbol : records.dates())
+    {
+        dateColumns.emplace(dateSymbol, 3 + static_cast<int>(dateColumns.size()) * modesNum);
+    }
+
+    // Position of each mode's column within a date
+    std::unordered_map<StringInterner::Symbol, int> modeOffsets;
+    for (const auto &record : recordList)
+    {
+        if (modeOffsets.find(record.mode) == modeOffsets.end())
+        {
+            int modeOffset = findIndex(modes, std::string(records.text(record.mode)));
+            if (modeOffset == -1)
+            {
+                std::cerr << "ERROR: Unknown mode " << records.text(record.mode) << std::endl;
+                return false;
+            }
+            modeOffsets.emplace(record.mode, modeOffset);
+        }
+    }
+
+    std::vector<std::size_t> allRecords(recordList.size());
+    std::iota(allRecords.begin(), allRecords.end(), 0);
+    auto recordsBySection = groupBySection(records, allRecords);
+    const std::vector<std::string> &sections = roster.sections();
+
+    // Only the sections of the roster get a sheet, the records of another
+    // section would be missing from the file (and marked as written)
+    std::unordered_set<std::string_view> rosterSections(sections.begin(), sections.end());
+    for (const auto &[section, indices] : recordsBySection)
+    {
+        if (rosterSections.find(section) == rosterSections.end())
+        {
+            std::cerr << "ERROR: The section " << section << " of " << indices.size() << " records is not in the students data" << std::endl;
+            return false;
+        }
+    }
+
+    XlsxStreamWriter writer;
+    if (!writer.open(filename))
+    {
+        std::cerr << "ERROR: Unable to create " << filename << std::endl;
+        return false;
+    }
+
+    // The sections' sheets are built on the pool, one per worker at a time,
+    // each into its own buffer. Each batch is written to the file, then
+    // freed, so only a batch of sheets is in memory at once
+    ThreadPool pool;
+    std::size_t batchSize = static_cast<std::size_t>(pool.size());
+    for (std::size_t first = 0; first < sections.size(); first += batchSize)
+    {
+        std::size_t last = std::min(first + batchSize, sections.size());
+        std::vector<SheetBuffer> sheets(last - first);
+        std::vector<std::string> errors(last - first);
+
+        for (std::size_t i = first; i < last; ++i)
+        {
+            pool.submit([&, i]
+                        {
+                const std::string &section = sections[i];
+                SheetBuffer &sheet = sheets[i - first];
+
+                // Dates (row 3) and modes (row 4)
+                sheet.beginRow(3);
+                for (auto dateSymbol : records.dates())
+                {
+                    for (int j = 0; j < modesNum; ++j)
+                    {
+                        sheet.cell(dateColumns.at(dateSymbol) + j, records.text(dateSymbol));
+                    }
+                }
+                sheet.beginRow(4);
+                for (std::size_t j = 0; j < records.dates().size(); ++j)
+                {
+                    for (int k = 0; k < modesNum; ++k)
+                    {
+                        sheet.cell(3 + static_cast<int>(j) * modesNum + k, modes[k]);
+                    }
+                }
+
+                auto sectionRecords = recordsBySection.find(section);
+                if (sectionRecords == recordsBySection.end())
+                {
+                    return;
+                }
+                const std::vector<std::size_t> &indices = sectionRecords->second;
+
+                // The students get a row each (from row 5), in the order they were first recorded
+                std::unordered_map<StringInterner::Symbol, std::size_t> studentNumbers;
+                std::vector<const StudentRecord *> students;
+                std::vector<std::size_t> recordsPerStudent;
+                for (std::size_t index : indices)
+                {
+                    StringInterner::Symbol id = recordList[index].id;
+                    auto [studentNumber, inserted] = studentNumbers.try_emplace(id, students.size());
+                    if (inserted)
+                    {
+                        const StudentRecord *student = roster.find(records.text(id));
+                        if (student == nullptr || roster.courseAndSection(*student) != section)
+                        {
+                            errors[i - first] = "The student " + std::string(records.text(id)) + " is not registered in " + section;
+                            return;
+                        }
+                        students.push_back(student);
+                        recordsPerStudent.push_back(0);
+                    }
+                    recordsPerStudent[studentNumber->second]++;
+                }
+
+                // Sorts the records of the section by row (counting sort),
+                // so that the rows are built in order
+                std::vector<std::size_t> rowStarts(students.size() + 1, 0);
+                for (std::size_t j = 0; j < students.size(); ++j)
+                {
+                    rowStarts[j + 1] = rowStarts[j] + recordsPerStudent[j];
+                }
+                std::vector<std::size_t> byRow(indices.size());
+                std::vector<std::size_t> nextSlot(rowStarts.begin(), rowStarts.end() - 1);
+                for (std::size_t index : indices)
+                {
+                    byRow[nextSlot[studentNumbers[recordList[index].id]]++] = index;
+                }
+
+                // The cells (column, time) of one row
+                std::vector<std::pair<int, std::uint16_t>> rowCells;
+                for (std::size_t j = 0; j < students.size(); ++j)
+                {
+                    rowCells.clear();
+                    for (std::size_t slot = rowStarts[j]; slot < rowStarts[j + 1]; ++slot)
+                    {
+                        const AttendanceRecord &record = recordList[byRow[slot]];
+                        rowCells.emplace_back(dateColumns.at(record.date) + modeOffsets.at(record.mode), record.minutes);
+                    }
+                    std::sort(rowCells.begin(), rowCells.end());
+
+                    sheet.beginRow(5 + static_cast<int>(j));
+                    sheet.cell(1, roster.id(*students[j]));
+                    sheet.cell(2, roster.name(*students[j]));
+                    for (const auto &[column, minutes] : rowCells)
+                    {
+                        sheet.cell(column, formatClockTime(minutes));
+                    }
+                } });
+        }
+        pool.wait();
+
+        for (const auto &error : errors)
+        {
+            if (!error.empty())
+            {
+                std::cerr << "ERROR: " << error << std::endl;
+                return false;
+            }
+        }
+
+        std::vector<std::string> names(sections.begin() + first, sections.begin() + last);
+        if (!writer.writeSheets(names, sheets, pool))
+        {
+            std::cerr << "ERROR: Unable to write " << filename << std::endl;
+            return false;
+        }
+    }
+
+    if (!writer.close())
+    {
+        std::cerr << "ERROR: Unable to write " << filename << std::endl;
+        return false;
+    }
+
+    // Every record is now in the file, the next exports only add the new ones
+    mark = ExportMark(filename);
+    mark.markExported(records);
+    return mark.save();
+}
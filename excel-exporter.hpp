@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <OpenXLSX.hpp>
+
+#include "attendance-records.hpp"
+#include "export-mark.hpp"
+#include "roster.hpp"
+#include "sheet-index.hpp"
+#include "workbook-catalog.hpp"
+
+// Writes the attendance data to the excel file, one sheet per section
+//
+//      Row 3: dates, each date spans 4 columns (one per mode)
+//      Row 4: modes
+//      Column A: IDs
+//      Column B: names
+//      Cells: time of the scan
+class ExcelExporter
+{
+public:
+    ExcelExporter(const Roster &roster, std::vector<std::string> modes);
+
+    // Opens the excel file if it exists, otherwise creates it. Only the
+    // records added since the last export to this file are written (see
+    // export-mark.hpp)
+    void open(const std::string &filename);
+
+    // Writes the headers (dates, names and IDs) of the records not written
+    // yet that are not already on the sheets, creating the sheets of new
+    // sections. Returns the IDs of these records that are not registered,
+    // in the order they were recorded
+    std::vector<std::string> writeHeaders(const AttendanceRecords &records);
+
+    // Number of records not written yet, known after `writeHeaders`
+    std::size_t pendingRecords() const;
+
+    // Writes the times of the records not written yet to the cells, the
+    // headers must be written first. Returns false if a header is missing
+    bool writeTimes(const AttendanceRecords &records);
+
+    // Saves the excel file if anything was written to it, then the mark
+    void save();
+    void close();
+
+    // The IDs of the records that are not registered, in the order they were recorded
+    std::vector<std::string> findUnregisteredIDs(const AttendanceRecords &records) const;
+
+    // Writes a new excel file with every record, replacing the file if it
+    // exists. The sections' sheets are built in parallel, then written in
+    // one pass (see xlsx-stream-writer.hpp) instead of going through
+    // OpenXLSX, for the same layout. Returns false if a record does not fit
+    // the roster or the file could not be written
+    bool rebuild(const std::string &filename, const AttendanceRecords &records);
+
+private:
+    const Roster &roster;
+    std::vector<std::string> modes;
+
+    OpenXLSX::XLDocument doc;
+    ExportMark mark{""};
+
+    // Indices of the records to write, and whether the excel file has
+    // changes to save
+    std::vector<std::size_t> pending;
+    bool modified = false;
+
+    // The sheets of `doc` and their header positions (date -> column, ID -> row).
+    // The single way to the sheets, so that it stays up to date
+    WorkbookCatalog catalog;
+};
@@ -0,0 +1,182 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "export-mark.hpp"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+static const int markVersion = 1;
+
+static std::string groupKey(std::string_view date, std::string_view courseAndSection, std::string_view mode)
+{
+    std::string key;
+    key.reserve(date.size() + courseAndSection.size() + mode.size() + 2);
+    key.append(date).append(1, '\n').append(courseAndSection).append(1, '\n').append(mode);
+    return key;
+}
+
+// Size and last write time of the excel file, to detect changes made
+// outside of this program (ex. saved from Excel)
+static bool workbookStamp(const std::string &filename, std::int64_t &size, std::int64_t &modified)
+{
+    std::error_code error;
+    auto fileSize = fs::file_size(filename, error);
+    if (error)
+    {
+        return false;
+    }
+    auto writeTime = fs::last_write_time(filename, error);
+    if (error)
+    {
+        return false;
+    }
+    size = static_cast<std::int64_t>(fileSize);
+    modified = static_cast<std::int64_t>(writeTime.time_since_epoch().count());
+    return true;
+}
+
+ExportMark::ExportMark(std::string workbookFilename)
+    : workbookFilename(std::move(workbookFilename))
+{
+}
+
+std::string ExportMark::filename() const
+{
+    return workbookFilename + ".qrar-export.json";
+}
+
+bool ExportMark::load()
+{
+    exported.clear();
+
+    std::string markFilename = filename();
+    std::int64_t size, modified;
+    if (!fs::exists(markFilename) || !workbookStamp(workbookFilename, size, modified))
+    {
+        return false;
+    }
+
+    try
+    {
+        std::ifstream f(markFilename);
+        json mark = json::parse(f);
+        if (mark.at("version").get<int>() != markVersion)
+        {
+            return false;
+        }
+        if (mark.at("workbookSize").get<std::int64_t>() != size || mark.at("workbookModified").get<std::int64_t>() != modified)
+        {
+            std::cout << workbookFilename << " was changed since the last export, every record will be written again." << std::endl;
+            return false;
+        }
+
+        for (auto &recordsByDate : mark.at("exported").items())
+        {
+            for (auto &recordsBySection : recordsByDate.value().items())
+            {
+                for (auto &countByMode : recordsBySection.value().items())
+                {
+                    exported[groupKey(recordsByDate.key(), recordsBySection.key(), countByMode.key())] = countByMode.value().get<std::size_t>();
+                }
+            }
+        }
+    }
+    catch (const json::exception &e)
+    {
+        std::cerr << "Ignoring " << markFilename << ": " << e.what() << std::endl;
+        exported.clear();
+        return false;
+    }
+    return true;
+}
+
+void ExportMark::clear()
+{
+    exported.clear();
+}
+
+std::vector<std::size_t> ExportMark::pending(const AttendanceRecords &records) const
+{
+    const std::vector<AttendanceRecord> &recordList = records.records();
+    std::vector<std::size_t> pendingRecords;
+
+    // Per date/section/mode: the number of records written, and the number seen so far
+    std::map<std::tuple<StringInterner::Symbol, StringInterner::Symbol, StringInterner::Symbol>, std::pair<std::size_t, std::size_t>> groups;
+    std::size_t markedGroups = 0;
+
+    for (std::size_t i = 0; i < recordList.size(); ++i)
+    {
+        const AttendanceRecord &record = recordList[i];
+        auto [group, inserted] = groups.try_emplace(std::make_tuple(record.date, record.courseAndSection, record.mode));
+        if (inserted)
+        {
+            auto found = exported.find(groupKey(records.text(record.date), records.text(record.courseAndSection), records.text(record.mode)));
+            if (found != exported.end())
+            {
+                group->second.first = found->second;
+                ++markedGroups;
+            }
+        }
+        if (++group->second.second > group->second.first)
+        {
+            pendingRecords.push_back(i);
+        }
+    }
+
+    // A date/section/mode that was written is missing or has fewer records:
+    // this is not the data that was exported, so everything is written again
+    bool replaced = markedGroups < exported.size();
+    for (const auto &group : groups)
+    {
+        replaced = replaced || group.second.second < group.second.first;
+    }
+    if (replaced)
+    {
+        pendingRecords.resize(recordList.size());
+        for (std::size_t i = 0; i < recordList.size(); ++i)
+        {
+            pendingRecords[i] = i;
+        }
+    }
+    return pendingRecords;
+}
+
+void ExportMark::markExported(const AttendanceRecords &records)
+{
+    exported.clear();
+    for (const auto &record : records.records())
+    {
+        ++exported[groupKey(records.text(record.date), records.text(record.courseAndSection), records.text(record.mode))];
+    }
+}
+
+bool ExportMark::save() const
+{
+    std::int64_t size, modified;
+    if (!workbookStamp(workbookFilename, size, modified))
+    {
+        std::cerr << "Error: Unable to read " << workbookFilename << std::endl;
+        return false;
+    }
+
+    json mark = {{"version", markVersion}, {"workbookSize", size}, {"workbookModified", modified}, {"exported", json::object()}};
+    for (const auto &[key, count] : exported)
+    {
+        std::size_t dateEnd = key.find('\n');
+        std::size_t sectionEnd = key.find('\n', dateEnd + 1);
+        mark["exported"][key.substr(0, dateEnd)][key.substr(dateEnd + 1, sectionEnd - dateEnd - 1)][key.substr(sectionEnd + 1)] = count;
+    }
+
+    std::string text = mark.dump(4);
+    text += '\n';
+    return writeFileAtomically(filename(), text);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "attendance-records.hpp"
+
+// What of the attendance data was already written to an excel file, kept
+// next to it (ex. "CCIS_ATTENDANCE.xlsx.qrar-export.json")
+// Structure:
+//      {
+//          version: 1,
+//          workbookSize: [size of the excel file when the mark was written],
+//          workbookModified: [last write time of the excel file],
+//          exported: {
+//              [date]: {
+//                  [course_and_section]: {
+//                      [mode]: [number of records written]
+//                  }
+//              }
+//          }
+//      }
+//
+// The records of a date/section/mode are only ever appended (see
+// AttendanceRecords::add), so the first N of them are the ones written
+class ExportMark
+{
+public:
+    explicit ExportMark(std::string workbookFilename);
+
+    // Name of the mark file, next to the excel file
+    std::string filename() const;
+
+    // Reads the mark. Returns false (the mark is then empty) if there is
+    // none, if it is invalid, or if the excel file was changed since
+    bool load();
+
+    // Forgets what was written, every record is then pending
+    void clear();
+
+    // Indices of the records not written yet, in the order they were
+    // recorded. Every record is pending if a date/section/mode has fewer
+    // records than were written (the attendance data was replaced)
+    std::vector<std::size_t> pending(const AttendanceRecords &records) const;
+
+    // Marks every record as written, see `save`
+    void markExported(const AttendanceRecords &records);
+
+    // Writes the mark with the current size and time of the excel file,
+    // which must be saved first. Returns false if it could not be written
+    bool save() const;
+
+private:
+    std::string workbookFilename;
+
+    // Number of records written per date/section/mode, keyed by
+    // "[date]\n[course_and_section]\n[mode]"
+    std::unordered_map<std::string, std::size_t> exported;
+};
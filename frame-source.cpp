@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <thread>
+
+#include <opencv2/opencv.hpp>
+
+#include "frame-source.hpp"
+
+namespace fs = std::filesystem;
+
+bool FrameSource::next(cv::Mat &frame)
+{
+    if (frameInterval.count() > 0)
+    {
+        // Keeps a fixed schedule instead of sleeping a fixed time, so that
+        // slow reads do not lower the frame rate
+        auto now = std::chrono::steady_clock::now();
+        if (!paceStarted)
+        {
+            paceStarted = true;
+            nextFrameTime = now;
+        }
+        if (nextFrameTime > now)
+        {
+            std::this_thread::sleep_until(nextFrameTime);
+        }
+        nextFrameTime += frameInterval;
+    }
+    return read(frame);
+}
+
+bool FrameSource::finished() const
+{
+    return false;
+}
+
+bool FrameSource::isLive() const
+{
+    return false;
+}
+
+void FrameSource::setFrameRate(double fps)
+{
+    frameInterval = fps > 0
+                        ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / fps))
+                        : std::chrono::steady_clock::duration(0);
+    paceStarted = false;
+}
+
+bool FrameSource::isRealTime() const
+{
+    return isLive() || frameInterval.count() > 0;
+}
+
+CameraSource::CameraSource(int index)
+    : capture(index)
+{
+}
+
+bool CameraSource::isOpened() const
+{
+    return capture.isOpened();
+}
+
+bool CameraSource::isLive() const
+{
+    return true;
+}
+
+bool CameraSource::read(cv::Mat &frame)
+{
+    return capture.read(frame) && !frame.empty();
+}
+
+VideoFileSource::VideoFileSource(const std::string &filename)
+    : capture(filename)
+{
+}
+
+bool VideoFileSource::isOpened() const
+{
+    return capture.isOpened();
+}
+
+bool VideoFileSource::finished() const
+{
+    return endReached;
+}
+
+bool VideoFileSource::read(cv::Mat &frame)
+{
+    if (endReached)
+    {
+        return false;
+    }
+    if (!capture.read(frame) || frame.empty())
+    {
+        endReached = true;
+        return false;
+    }
+    return true;
+}
+
+ImageDirectorySource::ImageDirectorySource(const std::string &directory)
+{
+    std::error_code error;
+    for (const auto &entry : fs::directory_iterator(directory, error))
+    {
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp")
+        {
+            imagePaths.push_back(entry.path().string());
+        }
+    }
+    std::sort(imagePaths.begin(), imagePaths.end());
+}
+
+bool ImageDirectorySource::isOpened() const
+{
+    return !imagePaths.empty();
+}
+
+bool ImageDirectorySource::finished() const
+{
+    return nextImage >= imagePaths.size();
+}
+
+bool ImageDirectorySource::read(cv::Mat &frame)
+{
+    // Skips the images that cannot be read
+    while (nextImage < imagePaths.size())
+    {
+        frame = cv::imread(imagePaths[nextImage++]);
+        if (!frame.empty())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::unique_ptr<FrameSource> openFrameSource(const std::string &input)
+{
+    std::unique_ptr<FrameSource> source;
+    if (input.empty() || input == "camera")
+    {
+        source = std::make_unique<CameraSource>(0);
+    }
+    else if (input.rfind("camera:", 0) == 0)
+    {
+        try
+        {
+            source = std::make_unique<CameraSource>(std::stoi(input.substr(7)));
+        }
+        catch (const std::exception &)
+        {
+            return nullptr;
+        }
+    }
+    else if (fs::is_directory(input))
+    {
+        source = std::make_unique<ImageDirectorySource>(input);
+    }
+    else
+    {
+        source = std::make_unique<VideoFileSource>(input);
+    }
+
+    if (!source->isOpened())
+    {
+        return nullptr;
+    }
+    return source;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// Where the scanned frames come from: the webcam, or a recording replayed
+// to reproduce a workload without a camera (ex. the morning rush at a gate)
+class FrameSource
+{
+public:
+    virtual ~FrameSource() = default;
+
+    virtual bool isOpened() const = 0;
+
+    // Reads the next frame, waiting first if the source is paced (see
+    // setFrameRate). Returns false if no frame could be read
+    bool next(cv::Mat &frame);
+
+    // True once a recording has no frames left. A camera never finishes
+    virtual bool finished() const;
+
+    // A live source (a camera) produces frames whether they are read or not
+    virtual bool isLive() const;
+
+    // Replays the recording at this many frames per second,
+    // 0 replays it as fast as the frames are read (the default)
+    void setFrameRate(double fps);
+
+    // True if frames keep coming at their own pace, so that frames have to
+    // be dropped when the decoders fall behind (a camera, or a paced replay)
+    bool isRealTime() const;
+
+protected:
+    virtual bool read(cv::Mat &frame) = 0;
+
+private:
+    std::chrono::steady_clock::duration frameInterval{0};
+    std::chrono::steady_clock::time_point nextFrameTime;
+    bool paceStarted = false;
+};
+
+class CameraSource : public FrameSource
+{
+public:
+    explicit CameraSource(int index);
+
+    bool isOpened() const override;
+    bool isLive() const override;
+
+protected:
+    bool read(cv::Mat &frame) override;
+
+private:
+    cv::VideoCapture capture;
+};
+
+class VideoFileSource : public FrameSource
+{
+public:
+    explicit VideoFileSource(const std::string &filename);
+
+    bool isOpened() const override;
+    bool finished() const override;
+
+protected:
+    bool read(cv::Mat &frame) override;
+
+private:
+    cv::VideoCapture capture;
+    bool endReached = false;
+};
+
+// The images of a directory (png, jpg, jpeg, bmp), in filename order
+class ImageDirectorySource : public FrameSource
+{
+public:
+    explicit ImageDirectorySource(const std::string &directory);
+
+    bool isOpened() const override;
+    bool finished() const override;
+
+protected:
+    bool read(cv::Mat &frame) override;
+
+private:
+    std::vector<std::string> imagePaths;
+    std::size_t nextImage = 0;
+};
+
+// Opens the source named by `input`:
+//      "" or "camera"      the default webcam
+//      "camera:N"          webcam number N
+//      a directory         its images
+//      anything else       a video file
+// Returns nullptr if the input could not be opened
+std::unique_ptr<FrameSource> openFrameSource(const std::string &input);
@@ -2,43 +2,119 @@
 #include <fstream>
 #include <filesystem>
 #include <vector>
+#include <memory>
 #include <string>
-#include <algorithm>
 #include <csignal>
 #include <iomanip>
 #include <chrono>
-#include <ctime>
 
 #include <opencv2/opencv.hpp>
 #include "ZXingOpenCV.h"
 #include "ReadBarcode.h"
 #include "BarcodeFormat.h"
 #include "DecodeHints.h"
-#include <OpenXLSX.hpp>
-#include <nlohmann/json.hpp>
 
 #include "utils.hpp"
+#include "roster.hpp"
+#include "attendance-store.hpp"
+#include "event-log.hpp"
+#include "scan-processor.hpp"
+#include "excel-exporter.hpp"
+#include "frame-source.hpp"
+#include "metrics.hpp"
+#include "scan-pipeline.hpp"
+#include "scanner-config.hpp"
 
-using namespace OpenXLSX;
 namespace fs = std::filesystem;
-using json = nlohmann::json;
 
-int main()
+// Set by SIGINT/SIGTERM in headless mode. The scanning then stops and the
+// data is saved, as when Esc is pressed in the window
+static volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int)
+{
+	stopRequested = 1;
+}
+
+int main(int argc, char *argv[])
 {
+	// Usage: qrar [--headless] [--excel FILE] [--mode N] [--input SOURCE] [--fps N]
+	//      --headless  no window, scans until Ctrl+C (SIGINT) or SIGTERM
+	//      --excel     excel file to use or create, instead of asking
+	//      --mode      [1] AM Time In [2] AM Time Out [3] PM Time In [4] PM Time Out, instead of asking
+	//      --input     camera (default), camera:N, a video file or a directory of images
+	//      --fps       replays a video file or directory at this rate (default: as fast as possible)
+	//      --metrics   writes timings and counters as JSON lines to this file, or to stderr with "-"
+	//      --metrics-interval  also writes them every N seconds (default: only at exit)
+	//      --export-json  also writes the attendance data to this file in the structure of backup.json
+	//      --station   name of this station in its event log (default: the computer's name), see event-log.hpp
+	//      --full-rebuild  writes the excel file again from the attendance data, not only the records added since the last export.
+	//                      The file is replaced: sheets and cells added by hand are not kept
+	bool headless = hasOption(argc, argv, "--headless");
+	bool fullRebuild = hasOption(argc, argv, "--full-rebuild");
+	std::string input = getOptionValue(argc, argv, "--input", "camera");
+	std::string metricsDestination = getOptionValue(argc, argv, "--metrics", "");
+	std::string exportJsonFilename = getOptionValue(argc, argv, "--export-json", "");
+	std::string station = getOptionValue(argc, argv, "--station", defaultStationName());
+	double replayFps;
+	int metricsInterval;
+	try
+	{
+		replayFps = std::stod(getOptionValue(argc, argv, "--fps", "0"));
+		metricsInterval = std::stoi(getOptionValue(argc, argv, "--metrics-interval", "0"));
+	}
+	catch (const std::exception &)
+	{
+		std::cerr << "Invalid option value, expected a number." << std::endl;
+		return 1;
+	}
+
+	// Exits with `code`. The console is kept open until a key is entered,
+	// except in headless mode where nobody is there to enter it
+	auto finish = [headless](int code)
+	{
+		if (!headless)
+		{
+			pause();
+		}
+		return code;
+	};
+
+	// Instrumentation (see metrics.hpp), null when disabled. The last
+	// snapshot is written when `metrics` is destroyed, on any exit path
+	std::unique_ptr<Metrics> metrics;
+	if (!metricsDestination.empty())
+	{
+		metrics = std::make_unique<Metrics>(metricsDestination);
+		if (!metrics->open())
+		{
+			return 1;
+		}
+		metrics->startPeriodicReports(std::chrono::seconds(metricsInterval));
+	}
+	PhaseTimer phaseTimer(metrics.get(), "1-select-file");
+
 	// ************************ PHASE 1 ************************
 	// Gets the filename of the excel file to be used
 
 	std::string programDirectory = ".";
 
-	std::string excelFilename;
-	bool noInitialFile = false;
+	std::string excelFilename = getOptionValue(argc, argv, "--excel", "");
 
-	while (true)
+	if (!excelFilename.empty())
+	{
+		if (!endsWith(excelFilename, ".xlsx"))
+		{
+			excelFilename += ".xlsx";
+		}
+		std::cout << (fs::exists(excelFilename) ? "Now using " : "Creating ") << excelFilename << " as the local database." << std::endl;
+	}
+
+	while (excelFilename.empty())
 	{
 		std::vector<std::string> excelFiles = getExcelFiles(programDirectory);
 		if (excelFiles.empty())
 		{
-			noInitialFile = true;
 			std::cout << "No xlsx files found in the directory." << std::endl;
 			std::cout << "Please enter a filename for the excel file to be created. Press enter if you would like the default name [CCIS_ATTENDANCE.xlsx]\n> ";
 
@@ -128,12 +204,31 @@ int main()
 
 	// Input Mode
 
-	std::vector<std::string> modes =
-		{"AM Time In", "AM Time Out", "PM Time In", "PM Time Out"};
+	const std::vector<std::string> &modes = attendanceModes();
 
-	int modeNum;
-	std::cout << "\n\nSelect MODE\n[1] AM Time In\n[2] AM Time Out\n[3] PM Time In\n[4] PM Time Out\n> ";
-	while (true)
+	int modeNum = 0;
+	std::string modeOption = getOptionValue(argc, argv, "--mode", "");
+	if (!modeOption.empty())
+	{
+		try
+		{
+			modeNum = std::stoi(modeOption);
+		}
+		catch (const std::exception &)
+		{
+			modeNum = 0;
+		}
+		if (modeNum < 1 || modeNum > 4)
+		{
+			std::cerr << "Invalid mode: " << modeOption << ", expected 1 to 4." << std::endl;
+			return 1;
+		}
+	}
+	else
+	{
+		std::cout << "\n\nSelect MODE\n[1] AM Time In\n[2] AM Time Out\n[3] PM Time In\n[4] PM Time Out\n> ";
+	}
+	while (modeNum < 1 || modeNum > 4)
 	{
 		std::cin >> modeNum;
 		if (modeNum >= 1 && modeNum <= 4)
@@ -145,10 +240,14 @@ int main()
 	std::string mode = modes[modeNum - 1];
 
 	// ************************ PHASE 2 ************************
+	phaseTimer.next("2-load-backup");
 	// Opens and retrieves the data from the backup [1] and the students data [2]
 
-	// [1] The backup data (backup.json) serves as the temporary store for the attendance data
-	// Structure:
+	// [1] The backup data (backup.bin) serves as the temporary store for the attendance data.
+	// It is a binary snapshot of packed records (see attendance-records.hpp).
+	// Older versions kept it as JSON (backup.json), which is imported once
+	// when there is no snapshot yet, and can still be written with --export-json
+	// Structure of backup.json:
 	//		{
 	//          attendance: {
 	//              [date]: {
@@ -178,434 +277,303 @@ int main()
 	if (!isFileInCurrentDirectory(studentsDataFilename))
 	{
 		std::cout << "NO STUDENTS DATA (students-data.json) FOUND.\nPlease create one first before using this program. Use the students-data.exe program for this." << std::endl;
-		std::cout << "Press Enter to exit...\n> ";
-		std::cin.get();
+		if (!headless)
+		{
+			std::cout << "Press Enter to exit...\n> ";
+			std::cin.get();
+		}
 		return 0;
 	}
 
-	// Syntax to initialize an object
-	// The values inside the parentheses are arguments to ifstream constructor
-	std::ifstream f("students-data.json");
-
-	json studentsData = json::parse(f);
-
-	std::string backupFilename = "backup.json";
-	json backupData;
-
-	if (isFileInCurrentDirectory(backupFilename))
+	// The journal (backup.journal) holds the scans recorded since backup.bin
+	// was last written. If the previous session did not exit cleanly, its
+	// scans are recovered from the journal (see attendance-store.hpp)
+	AttendanceStore store("backup.bin", "backup.journal", "backup.json");
+	if (!store.open())
 	{
-		std::ifstream f(backupFilename);
-		backupData = json::parse(f);
+		return finish(1);
 	}
-	else
+	if (store.importedScans() > 0)
 	{
-		// Creates/initializes the backup.json file
-		std::ofstream outputFile(backupFilename);
-		if (!outputFile.is_open())
-		{
-			std::cerr << "Error: Unable to create the JSON file." << std::endl;
-		}
-
-		backupData = {{"attendance", json::object()}};
+		std::cout << "Imported " << store.importedScans() << " scans from backup.json." << std::endl;
+	}
+	if (store.recoveredScans() > 0)
+	{
+		std::cout << "Recovered " << store.recoveredScans() << " scans from the previous session." << std::endl;
+	}
 
-		std::ofstream o(backupFilename);
-		o << std::setw(4) << backupData << std::endl;
+	// Every scan recorded by this station is also kept in its event log, so
+	// that the scans of several stations can be merged with qrar-merge
+	EventLog eventLog(eventLogFilename(station), station);
+	if (!eventLog.open())
+	{
+		return finish(1);
 	}
 
 	// ************************ PHASE 3 ************************
-	// Converts the json into a list, for easier searching of data
-	// This list contains objects, where each object contains all
-	// information needed about one student
-
-	// Structure:
-	//      [
-	//          {
-	//              "name": [name],
-	//              "id": [id],
-	//              "course_and_section": [course_and_section]
-	//          }
-	//      ]
+	phaseTimer.next("3-load-roster");
+	// Converts the json into a roster, for faster searching of data
+	// The roster contains one record per student, with all information
+	// needed about the student, and an index of the records by ID
 
-	json students = json::array();
-	std::vector<std::string> sections;
+	// Record structure:
+	//      {
+	//          "name": [name],
+	//          "id": [id],
+	//          "course_and_section": [course_and_section]
+	//      }
 
-	for (auto &sectionData : studentsData.items())
+	Roster roster;
+	try
 	{
-		std::string section = sectionData.key();
-		if (!isInVector(sections, section))
-		{
-			sections.push_back(section);
-		}
-		json studentObjectsArray = sectionData.value();
-		for (const auto &studentObject : studentObjectsArray)
-		{
-			students.push_back({{"name", studentObject["name"]}, {"id", studentObject["id"]}, {"course_and_section", section}});
-		}
+		roster = Roster::fromFile(studentsDataFilename);
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << std::endl;
+		return finish(1);
 	}
 
 	// ************************ PHASE 4 ************************
+	phaseTimer.next("4-scan");
 	// Opens the webcam to scan QR codes
 
-	cv::namedWindow("Attendance Tracking Program");
+	// Reads the decoder settings of this station ("scanner-config.json",
+	// see scanner-config.hpp). The hints are built once and shared by every
+	// frame. By default only QR codes and Code128 (old cards) are searched
+	ScannerConfig scannerConfig;
+	ZXing::DecodeHints hints;
+	try
+	{
+		scannerConfig = loadScannerConfig(programDirectory + "/scanner-config.json");
+		hints = buildDecodeHints(scannerConfig);
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << std::endl;
+		return finish(1);
+	}
+
+	// In headless mode nothing is drawn or shown, the decoded frames are
+	// dropped as soon as they are decoded
+	scannerConfig.pipeline.metrics = metrics.get();
+	if (headless)
+	{
+		scannerConfig.pipeline.displayFrames = false;
+		scannerConfig.pipeline.drawResults = false;
+	}
+	else
+	{
+		cv::namedWindow("Attendance Tracking Program");
+	}
 
 	cv::Mat image;
-	cv::VideoCapture cap(0);
 
-	if (!cap.isOpened())
+	// The webcam, or a recording replayed in its place (see frame-source.hpp)
+	std::unique_ptr<FrameSource> frameSource = openFrameSource(input);
+
+	if (!frameSource)
 	{
-		std::cout << "Could not open camera" << std::endl;
+		std::cout << "Could not open " << (input == "camera" ? "camera" : input) << std::endl;
 		return 1;
 	}
+	frameSource->setFrameRate(replayFps);
+	// Timestamps the scans (see ClockService in utils.hpp)
+	ClockService clock;
+
 	// Gets the initial date to be checked with for date changes
 	// "%a %Y%m%d" Date format (ex. "Tue 11-29-2023")
-	std::string initialDate = datetimeStringByFormat("%a %m-%d-%Y");
+	std::string initialDate = clock.now().date;
 
 	std::cout << "\n\n******************** LOG ********************\n"
 			  << std::endl;
 
 	bool unregisteredDisplayed = false;
 
-	// Checks every 25 milliseconds if the
-	// "Esc" (ASCII code 27) key is not pressed
-	while (cv::waitKey(25) != 27)
-	{
-		// Captures frames from the camera
-		cap >> image;
+	ScanProcessor scanProcessor(roster, store, clock, mode);
 
-		// This configures the reader to be able to read barcodes also,
-		// aside from QR codes
-		auto hints = ZXing::DecodeHints().setFormats(ZXing::BarcodeFormat::Any);
+	// Outcomes of the scans passed to the processor, if the metrics are enabled
+	Counter *unregisteredScans = metrics ? &metrics->counter("scans.unregistered") : nullptr;
+	Counter *alreadyRecordedScans = metrics ? &metrics->counter("scans.alreadyRecorded") : nullptr;
+	Counter *storedScans = metrics ? &metrics->counter("scans.stored") : nullptr;
 
-		// ReadBarcodes (from ZXingOpenCV) extracts barcode info
-		auto results = ReadBarcodes(image, hints);
+	// Records one decoded ID. Only called from the recorder thread of the
+	// scan pipeline, so the store is never accessed concurrently
+	auto recordScan = [&](const std::string &decodedID)
+	{
+		ScanResult result = scanProcessor.process(decodedID);
 
-		// Iterates every barcodes or QR codes scanned in an image
-		for (auto &r : results)
+		if (metrics)
 		{
-			// Draws the result to the webcam monitor (from ZXingOpenCV)
-			DrawResult(image, r);
-
-			std::string decodedID = r.text();
-			std::string date = datetimeStringByFormat("%a %m-%d-%Y");
-
-			// "%H:%M" Time format (ex. "15:45")
-			std::string clockTime = datetimeStringByFormat("%H:%M");
-
-			auto iterator = std::find_if(students.begin(), students.end(), [decodedID](const json &obj)
-										 { return obj["id"] == decodedID; });
-
-			// Detects if the student with the scanned ID is registered or not
-			if (iterator == students.end())
+			switch (result.status)
 			{
-				if (!unregisteredDisplayed)
-				{
-					std::cout << "Unregistered." << std::endl;
-					unregisteredDisplayed = true;
-				}
+			case ScanStatus::Unregistered:
+				unregisteredScans->add();
+				break;
+			case ScanStatus::AlreadyRecorded:
+				alreadyRecordedScans->add();
+				break;
+			case ScanStatus::Recorded:
+				storedScans->add();
 				break;
 			}
-			else
+		}
+
+		if (result.status == ScanStatus::Unregistered)
+		{
+			if (!unregisteredDisplayed)
 			{
-				unregisteredDisplayed = false;
+				std::cout << "Unregistered." << std::endl;
+				unregisteredDisplayed = true;
 			}
+			return;
+		}
+		unregisteredDisplayed = false;
 
-			std::string courseAndSection = (*iterator)["course_and_section"];
+		if (result.status == ScanStatus::Recorded)
+		{
+			eventLog.append(result.event);
+			std::cout << result.event.date << " " << result.event.time << " " << result.name << "\a" << std::endl;
+		}
+	};
 
-			// Initializes the properties if they are not initialized yet
-			if (!backupData["attendance"].contains(date))
-			{
-				backupData["attendance"][date] = json::object();
-			}
-			if (!backupData["attendance"][date].contains(courseAndSection))
-			{
-				backupData["attendance"][date][courseAndSection] = json::object();
-			}
-			if (!backupData["attendance"][date][courseAndSection].contains(mode))
-			{
-				backupData["attendance"][date][courseAndSection][mode] = json::object();
-			}
+	// Captures, decodes and records on separate threads (see scan-pipeline.hpp)
+	// so that a slow decode does not stall the camera
+	ScanPipeline pipeline(*frameSource, hints, recordScan, scannerConfig.pipeline);
+	auto scanStart = std::chrono::steady_clock::now();
+	pipeline.start();
 
-			// Check if the student is registered or not
-			// If the student is registered, it stores the info (time)
-			if (iterator != students.end())
-			{
-				std::string studentName = (*iterator)["name"];
-				if (!backupData["attendance"][date][courseAndSection][mode].contains(decodedID))
-				{
-					backupData["attendance"][date][courseAndSection][mode][decodedID] = clockTime;
-					std::cout << date << " " << clockTime << " " << studentName << "\a" << std::endl;
-				}
-			}
-			else
+	if (headless)
+	{
+		// The pipeline's threads run as fast as the camera delivers, the
+		// main thread only waits for a stop signal
+		std::signal(SIGINT, requestStop);
+		std::signal(SIGTERM, requestStop);
+		std::cout << "Scanning in headless mode. Press Ctrl+C to stop." << std::endl;
+		while (!stopRequested && !pipeline.finished())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+		std::signal(SIGINT, SIG_DFL);
+		std::signal(SIGTERM, SIG_DFL);
+	}
+	else
+	{
+		// The UI stays on the main thread (HighGUI requires it) and only shows
+		// the most recent annotated frame
+		// Checks every 25 milliseconds if the
+		// "Esc" (ASCII code 27) key is not pressed
+		while (cv::waitKey(25) != 27 && !pipeline.finished())
+		{
+			if (pipeline.latestFrame(image))
 			{
-				std::cout << "Unregistered." << std::endl;
+				// Title/header of the window
+				cv::imshow("Attendance Tracking Program", image);
 			}
 		}
+	}
+
+	pipeline.stop();
+
+	double scanSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - scanStart).count();
+	if (!frameSource->isLive() && scanSeconds > 0)
+	{
+		std::cout << "Replayed " << pipeline.framesCaptured() << " frames in " << std::fixed << std::setprecision(2) << scanSeconds << " s ("
+				  << pipeline.framesCaptured() / scanSeconds << " frames/s), "
+				  << pipeline.scansDecoded() << " codes decoded (" << pipeline.scansDecoded() / scanSeconds << " scans/s), "
+				  << pipeline.scansRecorded() << " recorded." << std::defaultfloat << std::endl;
+	}
 
-		// Title/header of the window
-		cv::imshow("Attendance Tracking Program", image);
+	if (pipeline.framesDropped() > 0)
+	{
+		std::cout << pipeline.framesDropped() << " of " << pipeline.framesCaptured() << " frames were skipped to keep up with the camera." << std::endl;
 	}
 
 	std::cout << "\n*********************************************\n\n"
 			  << std::endl;
 
 	// ************************ PHASE 5 ************************
-	// Stores the data to the backup file ("backup.json")
+	phaseTimer.next("5-backup");
+	// Stores the data to the backup file ("backup.bin")
+
+	// The whole backup is only rewritten here, once per session. During the
+	// session the scans were persisted by appending them to the journal
 
 	std::cout << "Backing up data." << std::endl;
-	std::ofstream outputFile(backupFilename);
-	if (!outputFile.is_open())
+	if (!store.save())
 	{
 		std::cerr << "Error opening the file!" << std::endl;
-		pause();
-		return 1;
+		return finish(1);
+	}
+	store.close();
+	eventLog.close();
+
+	if (!exportJsonFilename.empty() && !store.exportJson(exportJsonFilename))
+	{
+		std::cerr << "Error writing " << exportJsonFilename << "!" << std::endl;
 	}
-	outputFile << backupData << std::endl;
-	outputFile.close();
 
 	// ************************ PHASE 6 ************************
+	phaseTimer.next("6-excel-headers");
 	// Stores the necessary headers (dates, names, and IDs) to the excel file
 
 	std::cout << "Writing to excel file." << std::endl;
 
-	// Opens the excel file if it exists, otherwise creates it
-	XLDocument doc;
-	if (noInitialFile)
+	ExcelExporter exporter(roster, modes);
+
+	// A new excel file, or a full rebuild, is written in one pass from the
+	// attendance data (see ExcelExporter::rebuild). Otherwise the excel file
+	// is opened and only the records added since the last export to it are
+	// written (see export-mark.hpp)
+	bool rebuild = fullRebuild || !fs::exists(excelFilename);
+
+	std::vector<std::string> unregisteredIDs;
+	if (rebuild)
 	{
-		doc.create(excelFilename);
+		unregisteredIDs = exporter.findUnregisteredIDs(store.data());
 	}
 	else
 	{
-		doc.open(excelFilename);
+		exporter.open(excelFilename);
+		unregisteredIDs = exporter.writeHeaders(store.data());
+		std::cout << exporter.pendingRecords() << " new records to write." << std::endl;
+		exporter.save();
 	}
 
-	XLWorkbook wbk = doc.workbook();
-
-	std::vector<std::string> unregisteredIDs;
-
-	for (const auto &section : sections)
+	if (unregisteredIDs.size() > 0)
 	{
-		// Creates the sheet only if it doesn't exists, otherwise uses it
-		std::vector<std::string> sheetNames;
-		for (const auto &sheetName : wbk.worksheetNames())
+		for (const auto &id : unregisteredIDs)
 		{
-			if (!isInVector(sheetNames, sheetName))
-			{
-				sheetNames.push_back(sheetName);
-			}
-		}
-		if (!isInVector(sheetNames, section))
-		{
-			doc.workbook().addWorksheet(section);
+			std::cout << "Student with the ID " << id << " is not registered on the system." << std::endl;
 		}
-		auto wks = doc.workbook().worksheet(section);
-
-		// Headers already written on the excel file before it is opened
-		std::vector<std::string> alreadyWrittenIDs;
-		std::vector<std::string> alreadyWrittenDates;
-
-		// Headers written by the program during runtime
-		std::vector<std::string> writtenIDs;
-		std::vector<std::string> writtenDates;
-
-		// Gets the dates already written to the sheet (in the third row), and
-		// Finds the first empty cell in the third row, starting from "C3"
-		XLCell currentCell = wks.cell(XLCellReference("C3"));
-		int currentColumnNum = 3;
-		while (currentCell.value().type() != XLValueType::Empty)
-		{
-			XLCellValue cellValue = currentCell.value();
-			std::string date = cellValue.get<std::string>();
-			if (!isInVector(alreadyWrittenDates, date))
-			{
-				alreadyWrittenDates.push_back(date);
-			}
-			currentCell = wks.cell(XLCellReference(3, ++currentColumnNum));
-		}
-		int lastEmptyColumn = currentColumnNum;
-
-		// Gets the IDs already written to the sheet, and
-		// Finds the first empty cell in the first column, starting from "A5"
-		XLCell currentCell2 = wks.cell(XLCellReference("A5"));
-		int currentRowNum = 5;
-		while (currentCell2.value().type() != XLValueType::Empty)
-		{
-			XLCellValue cellValue = currentCell2.value();
-			std::string id = cellValue.get<std::string>();
-			if (!isInVector(alreadyWrittenIDs, id))
-			{
-				alreadyWrittenIDs.push_back(id);
-			}
-			currentCell2 = wks.cell(XLCellReference(++currentRowNum, 1));
-		}
-		int lastEmptyRow = currentRowNum;
-
-		// Writes the date not already written to the column headers (row 3)
-		for (auto &recordsByDate : backupData["attendance"].items())
-		{
-			std::string date = recordsByDate.key();
-
-			if (!isInVector(alreadyWrittenDates, date) && !isInVector(writtenDates, date))
-			{
-				int lastColumn = lastEmptyColumn + 4;
-				for (int columnNum = lastEmptyColumn; columnNum < lastColumn; ++columnNum)
-				{
-					wks.cell(XLCellReference(3, columnNum)).value() = date;
-					wks.cell(XLCellReference(4, columnNum)).value() = modes[((columnNum - 3) % 4)];
-					lastEmptyColumn = columnNum + 1;
-				}
-				writtenDates.push_back(date);
-			}
-
-			for (auto &recordsByMode : backupData["attendance"][date][section].items())
-			{
-				std::string modeRecorded = recordsByMode.key();
-
-				// Writes the IDs and names not already written to the IDs/names headers (columns 1 and 2 respectively)
-				for (auto &recordsByID : backupData["attendance"][date][section][modeRecorded].items())
-				{
-					std::string id = recordsByID.key();
-					auto iterator = std::find_if(students.begin(), students.end(), [id](const json &obj)
-												 { return obj["id"] == id; });
-
-					// Detects if the student with the scanned ID is registered or not
-					if (iterator == students.end())
-					{
-						if (!isInVector(unregisteredIDs, id))
-						{
-							std::cout << "Student with the ID " << id << " is not registered on the system." << std::endl;
-							unregisteredIDs.push_back(id);
-						}
-						break;
-					}
-
-					std::string sectionOfStudent = (*iterator)["course_and_section"];
-
-					// Writes the clock to the sheet if the student is
-					// a student of the current section
-					if (sectionOfStudent == section)
-					{
-						if (!isInVector(alreadyWrittenIDs, id) && !isInVector(writtenIDs, id))
-						{
-							std::string studentName = (*iterator)["name"];
-							wks.cell(XLCellReference(lastEmptyRow, 1)).value() = id;
-							wks.cell(XLCellReference(lastEmptyRow, 2)).value() = studentName;
-							lastEmptyRow++;
-
-							writtenIDs.push_back(id);
-						}
-					}
-				}
-			}
-		}
-	}
-
-	doc.save();
-
-	if (unregisteredIDs.size() > 0)
-	{
 		std::cout << "You can use the students-data.exe program to register students." << std::endl;
-		pause();
-		return 0;
+		return finish(0);
 	}
 
 	// ************************ PHASE 7 ************************
+	phaseTimer.next("7-excel-times");
 	// Stores the times recorded to the excel file
 
-	wbk = doc.workbook();
-
-	for (auto &recordsByDate : backupData["attendance"].items())
+	if (rebuild)
 	{
-		std::string date = recordsByDate.key();
-		for (auto &recordsBySection : backupData["attendance"][date].items())
+		std::cout << "Writing every record (" << store.data().size() << ")..." << std::endl;
+		if (!exporter.rebuild(excelFilename, store.data()))
 		{
-			std::string section = recordsBySection.key();
-
-			// Open worksheet
-			auto wks = wbk.worksheet(section);
-			wbk.worksheet(section).setActive();
-
-			for (auto &recordsByMode : backupData["attendance"][date][section].items())
-			{
-				std::string modeRecorded = recordsByMode.key();
-
-				// Finds the column index to where the time info shall be placed for the student
-				// Start with cell C3
-				XLCell currentCell2 = wks.cell(XLCellReference("C3"));
-				int currentColumn = 3; // C column
-				int columnIndex;
-				while (true)
-				{
-					// If the column after the last (empty) is encountered
-					if (currentCell2.value().type() == XLValueType::Empty)
-					{
-						std::cout << "ERROR: Could not find the corresponding column coordinate for date " << date << std::endl;
-						pause();
-						return 1;
-					}
-
-					XLCellValue cellValue = currentCell2.value();
-					std::string cellStringValue = cellValue.get<std::string>();
-
-					if (cellStringValue == date)
-					{
-						columnIndex = currentColumn;
-						break;
-					}
-
-					currentColumn++;
-					currentCell2 = wks.cell(XLCellReference(3, currentColumn));
-				}
-
-				// Finds the appropriate column based on the mode
-				int index = findIndex(modes, modeRecorded);
-				columnIndex += index;
-
-				for (auto &recordsByIDs : backupData["attendance"][date][section][modeRecorded].items())
-				{
-					std::string id = recordsByIDs.key();
-					std::string time = recordsByIDs.value();
-
-					// Finds the row index to where the time info shall be placed for the student
-					XLCell currentCell = wks.cell(XLCellReference("A5"));
-					int currentRow = 5;
-					int rowIndex;
-
-					// If the row after the last (empty) is encountered
-					while (true)
-					{
-						if (currentCell.value().type() == XLValueType::Empty)
-						{
-							std::cout << "ERROR: Could not find the corresponding row coordinate of the student" << id << std::endl;
-							pause();
-							return 1;
-						}
-
-						XLCellValue cellValue = currentCell.value();
-						std::string cellStringValue = cellValue.get<std::string>();
-
-						if (cellValue == id)
-						{
-							rowIndex = currentRow;
-							break;
-						}
-
-						currentRow++;
-						currentCell = wks.cell(XLCellReference(currentRow, 1));
-					}
-
-					// Stores the time info to the target cell
-					wks.cell(XLCellReference(rowIndex, columnIndex)).value() = time;
-				}
-			}
+			return finish(1);
 		}
 	}
+	else
+	{
+		if (!exporter.writeTimes(store.data()))
+		{
+			return finish(1);
+		}
 
-	std::cout << "Saving excel file..." << std::endl;
-	doc.save();
-	doc.close();
-
-	pause();
+		std::cout << "Saving excel file..." << std::endl;
+		exporter.save();
+		exporter.close();
+	}
+	phaseTimer.stop();
 
-	return 0;
+	return finish(0);
 }
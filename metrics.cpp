@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <iostream>
+
+#include <nlohmann/json.hpp>
+
+#include "metrics.hpp"
+
+using json = nlohmann::json;
+
+void Counter::add(std::uint64_t n)
+{
+    count.fetch_add(n, std::memory_order_relaxed);
+}
+
+std::uint64_t Counter::value() const
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+void Histogram::record(MetricsClock::duration duration)
+{
+    auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    std::uint64_t value = microseconds > 0 ? static_cast<std::uint64_t>(microseconds) : 0;
+
+    buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+
+    std::uint64_t previous = maximum.load(std::memory_order_relaxed);
+    while (value > previous && !maximum.compare_exchange_weak(previous, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+std::uint64_t Histogram::count() const
+{
+    return total.load(std::memory_order_relaxed);
+}
+
+double Histogram::percentile(double p) const
+{
+    std::uint64_t recorded = count();
+    if (recorded == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the percentile, counted from 1
+    auto rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(recorded) + 0.5);
+    rank = std::clamp<std::uint64_t>(rank, 1, recorded);
+
+    std::uint64_t seen = 0;
+    for (int bucket = 0; bucket < bucketsNum; ++bucket)
+    {
+        seen += buckets[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            return static_cast<double>(std::min(bucketUpperBound(bucket), maximum.load(std::memory_order_relaxed)));
+        }
+    }
+    return maxMicroseconds();
+}
+
+double Histogram::maxMicroseconds() const
+{
+    return static_cast<double>(maximum.load(std::memory_order_relaxed));
+}
+
+int Histogram::bucketOf(std::uint64_t microseconds)
+{
+    if (microseconds < 16)
+    {
+        return static_cast<int>(microseconds);
+    }
+
+    // Position of the highest set bit, at least 4 here
+    int exponent = 4;
+    while (microseconds >> (exponent + 1))
+    {
+        exponent++;
+    }
+    int subBucket = static_cast<int>((microseconds >> (exponent - 3)) & 7);
+    return 16 + (exponent - 4) * 8 + subBucket;
+}
+
+std::uint64_t Histogram::bucketUpperBound(int bucket)
+{
+    if (bucket < 16)
+    {
+        return static_cast<std::uint64_t>(bucket);
+    }
+    int exponent = (bucket - 16) / 8 + 4;
+    std::uint64_t subBucket = static_cast<std::uint64_t>((bucket - 16) % 8);
+    return ((8 + subBucket + 1) << (exponent - 3)) - 1;
+}
+
+Metrics::Metrics(std::string destination)
+    : destination(std::move(destination)), started(MetricsClock::now())
+{
+}
+
+Metrics::~Metrics()
+{
+    stop();
+    report();
+}
+
+bool Metrics::open()
+{
+    if (destination == "-")
+    {
+        output = &std::cerr;
+        return true;
+    }
+
+    file.open(destination, std::ios::app);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Unable to open the metrics file " << destination << std::endl;
+        return false;
+    }
+    output = &file;
+    return true;
+}
+
+Counter &Metrics::counter(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &slot = counters[name];
+    if (!slot)
+    {
+        slot = std::make_unique<Counter>();
+    }
+    return *slot;
+}
+
+Histogram &Metrics::histogram(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &slot = histograms[name];
+    if (!slot)
+    {
+        slot = std::make_unique<Histogram>();
+    }
+    return *slot;
+}
+
+void Metrics::addPhase(const std::string &name, MetricsClock::duration duration)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    phases.emplace_back(name, std::chrono::duration<double, std::milli>(duration).count());
+}
+
+json Metrics::snapshot() const
+{
+    json data;
+    data["uptimeSeconds"] = std::chrono::duration<double>(MetricsClock::now() - started).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    data["phasesMs"] = json::object();
+    for (const auto &[name, milliseconds] : phases)
+    {
+        data["phasesMs"][name] = milliseconds;
+    }
+
+    data["counters"] = json::object();
+    for (const auto &[name, counter] : counters)
+    {
+        data["counters"][name] = counter->value();
+    }
+
+    data["histogramsUs"] = json::object();
+    for (const auto &[name, histogram] : histograms)
+    {
+        data["histogramsUs"][name] = {
+            {"count", histogram->count()},
+            {"p50", histogram->percentile(50)},
+            {"p90", histogram->percentile(90)},
+            {"p99", histogram->percentile(99)},
+            {"max", histogram->maxMicroseconds()}};
+    }
+    return data;
+}
+
+void Metrics::report()
+{
+    if (output == nullptr)
+    {
+        return;
+    }
+    std::string line = snapshot().dump();
+
+    std::lock_guard<std::mutex> lock(reportMutex);
+    *output << line << std::endl;
+}
+
+void Metrics::startPeriodicReports(std::chrono::seconds interval)
+{
+    if (interval.count() <= 0 || reportThread.joinable())
+    {
+        return;
+    }
+
+    stopping = false;
+    reportThread = std::thread([this, interval]()
+                               {
+        std::unique_lock<std::mutex> lock(reportMutex);
+        while (!wakeUp.wait_for(lock, interval, [this]() { return stopping; }))
+        {
+            lock.unlock();
+            report();
+            lock.lock();
+        } });
+}
+
+void Metrics::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    if (reportThread.joinable())
+    {
+        reportThread.join();
+    }
+}
+
+PhaseTimer::PhaseTimer(Metrics *metrics, std::string name)
+    : metrics(metrics), name(std::move(name)), running(metrics != nullptr)
+{
+    if (running)
+    {
+        started = MetricsClock::now();
+    }
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    stop();
+}
+
+void PhaseTimer::next(std::string nextName)
+{
+    stop();
+    if (metrics != nullptr)
+    {
+        name = std::move(nextName);
+        started = MetricsClock::now();
+        running = true;
+    }
+}
+
+void PhaseTimer::stop()
+{
+    if (running)
+    {
+        metrics->addPhase(name, MetricsClock::now() - started);
+        running = false;
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+using MetricsClock = std::chrono::steady_clock;
+
+// A count that can be increased from any thread
+class Counter
+{
+public:
+    void add(std::uint64_t n = 1);
+    std::uint64_t value() const;
+
+private:
+    std::atomic<std::uint64_t> count{0};
+};
+
+// Distribution of durations, in microseconds, that can be recorded from any
+// thread without locking. The buckets are 1 us wide below 16 us, then each
+// power of two is split in 8 buckets, so a percentile is within 12.5%
+class Histogram
+{
+public:
+    void record(MetricsClock::duration duration);
+
+    std::uint64_t count() const;
+
+    // Upper bound of the bucket holding the `p`th percentile (0 to 100), in microseconds
+    double percentile(double p) const;
+
+    double maxMicroseconds() const;
+
+private:
+    static constexpr int bucketsNum = 512;
+
+    static int bucketOf(std::uint64_t microseconds);
+    static std::uint64_t bucketUpperBound(int bucket);
+
+    std::array<std::atomic<std::uint64_t>, bucketsNum> buckets{};
+    std::atomic<std::uint64_t> total{0};
+    std::atomic<std::uint64_t> maximum{0};
+};
+
+// Counters, latency histograms and phase durations of a run, written as
+// JSON lines to a file or to stderr, optionally periodically, and a last
+// time when the metrics are destroyed
+//
+// The instrumented code holds a `Metrics *` that is null when the metrics
+// are disabled, so that a disabled run only pays for a pointer check (no
+// clock reads, no histograms)
+class Metrics
+{
+public:
+    // `destination` is a filename, or "-" for stderr
+    explicit Metrics(std::string destination);
+    ~Metrics();
+
+    Metrics(const Metrics &) = delete;
+    Metrics &operator=(const Metrics &) = delete;
+
+    // Returns false if the file could not be created
+    bool open();
+
+    // The returned references stay valid as long as the metrics
+    Counter &counter(const std::string &name);
+    Histogram &histogram(const std::string &name);
+
+    void addPhase(const std::string &name, MetricsClock::duration duration);
+
+    nlohmann::json snapshot() const;
+
+    // Writes the snapshot as one JSON line
+    void report();
+
+    // Reports every `interval` from a background thread, until `stop`
+    void startPeriodicReports(std::chrono::seconds interval);
+    void stop();
+
+private:
+    std::string destination;
+    std::ofstream file;
+    std::ostream *output = nullptr;
+    MetricsClock::time_point started;
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    std::vector<std::pair<std::string, double>> phases;
+
+    std::mutex reportMutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+    std::thread reportThread;
+};
+
+// Measures consecutive phases of the main thread
+//      PhaseTimer phaseTimer(metrics, "load");
+//      ...
+//      phaseTimer.next("scan");
+// Does nothing if `metrics` is null
+class PhaseTimer
+{
+public:
+    PhaseTimer(Metrics *metrics, std::string name);
+    ~PhaseTimer();
+
+    // Ends the current phase and starts the next one
+    void next(std::string name);
+
+    // Ends the current phase
+    void stop();
+
+private:
+    Metrics *metrics;
+    std::string name;
+    MetricsClock::time_point started;
+    bool running;
+};
@@ -1,6 +1,10 @@
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgcodecs.hpp>
@@ -11,23 +15,13 @@
 #include <nlohmann/json.hpp>
 
 #include "utils.hpp"
+#include "thread-pool.hpp"
+#include "qr-raster.hpp"
+#include "qr-manifest.hpp"
 
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
-cv::Mat BitMatrixToImage(const ZXing::BitMatrix &bitMatrix)
-{
-    cv::Mat image(bitMatrix.height(), bitMatrix.width(), CV_8UC1);
-    for (int y = 0; y < bitMatrix.height(); ++y)
-    {
-        for (int x = 0; x < bitMatrix.width(); ++x)
-        {
-            image.at<uchar>(y, x) = bitMatrix.get(x, y) ? 0 : 255;
-        }
-    }
-    return image;
-}
-
 void saveImageToFile(const cv::Mat &image, const std::string &filename)
 {
     if (!cv::imwrite(filename, image))
@@ -36,8 +30,40 @@ void saveImageToFile(const cv::Mat &image, const std::string &filename)
     }
 }
 
-int main()
+// One QR code image to be generated
+struct QRCodeJob
+{
+    std::string studentID;
+    std::string filename;
+};
+
+// Number of QR codes encoded per task, so that the pool's overhead is shared
+// by several codes
+static const std::size_t jobsPerBatch = 32;
+
+int main(int argc, char *argv[])
 {
+    // Usage: qr-code-generator [--jobs N] [--scale N] [--size N] [--quiet-zone N] [--force]
+    //      --jobs          number of threads generating the codes (default: one per core)
+    //      --scale         pixels per module (default: fit in --size)
+    //      --size          image size in pixels the code is fit in (default: 300)
+    //      --quiet-zone    white border in modules (default: 4)
+    //      --force         regenerates every code, even the unchanged ones
+    int threadsNum;
+    RasterOptions rasterOptions;
+    try
+    {
+        threadsNum = std::stoi(getOptionValue(argc, argv, "--jobs", "0"));
+        rasterOptions.scale = std::stoi(getOptionValue(argc, argv, "--scale", "0"));
+        rasterOptions.targetSize = std::stoi(getOptionValue(argc, argv, "--size", "300"));
+        rasterOptions.quietZone = std::stoi(getOptionValue(argc, argv, "--quiet-zone", "4"));
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << "Invalid option value, expected a number." << std::endl;
+        return 1;
+    }
+
     std::string studentsDataFilename = "students-data.json";
 
     if (!isFileInCurrentDirectory(studentsDataFilename))
@@ -62,6 +88,20 @@ int main()
         return 1;
     }
 
+    // The manifest records what each image was generated from, so that
+    // only the codes of added or changed students are generated again
+    std::string manifestFilename = "QR Codes/manifest.json";
+    // With --force every code is generated again, but the previous manifest
+    // is still read so that the images of removed students are deleted
+    bool force = hasOption(argc, argv, "--force");
+    QRManifest previousManifest = QRManifest::load(manifestFilename);
+    QRManifest manifest;
+    std::size_t unchangedNum = 0;
+
+    // The directories are created first, then the codes of all the
+    // sections are generated together
+    std::vector<QRCodeJob> jobs;
+
     for (auto &recordsBySection : studentsData.items())
     {
         std::string section = recordsBySection.key();
@@ -80,26 +120,78 @@ int main()
             return 1;
         }
 
-        json studentObjects = recordsBySection.value();
-
-        for (const auto &studentObject : studentObjects)
+        for (const auto &studentObject : recordsBySection.value())
         {
             std::string studentName = studentObject["name"];
             std::string studentID = studentObject["id"];
-            // Create a MultiFormatWriter for QR code
-            ZXing::MultiFormatWriter writer(ZXing::BarcodeFormat::QRCode);
+            std::string filename = sectionDirectoryName + "/" + studentName + " (" + studentID + ").png";
+
+            std::uint64_t contentHash = qrContentHash(studentID, studentName, rasterOptions);
+            manifest.set(filename, contentHash);
+            if (!force && previousManifest.isUpToDate(filename, contentHash))
+            {
+                unchangedNum++;
+                continue;
+            }
+            jobs.push_back({studentID, filename});
+        }
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
 
-            // Encode the data
-            ZXing::BitMatrix bitMatrix = writer.encode(studentID, 300, 300);
+    ThreadPool pool(threadsNum);
 
-            // Convert the BitMatrix to an image
-            cv::Mat image = BitMatrixToImage(bitMatrix);
+    // Each worker reuses its own MultiFormatWriter for QR codes
+    std::vector<ZXing::MultiFormatWriter> writers(pool.size(), createModuleWriter(ZXing::BarcodeFormat::QRCode));
+
+    // Encoding, converting and compressing (PNG) all happen on the workers
+    for (std::size_t first = 0; first < jobs.size(); first += jobsPerBatch)
+    {
+        std::size_t last = std::min(first + jobsPerBatch, jobs.size());
+        pool.submit([&jobs, &writers, &rasterOptions, first, last]
+                    {
+            ZXing::MultiFormatWriter &writer = writers[ThreadPool::currentWorker()];
+            for (std::size_t i = first; i < last; ++i)
+            {
+                // Encode the data to its modules (one bit per module)
+                ZXing::BitMatrix modules = encodeModules(writer, jobs[i].studentID);
+
+                // Convert the modules to an image, with the quiet zone
+                cv::Mat image = rasterizeModules(modules, rasterOptions);
+
+                // Save the image or process it further
+                saveImageToFile(image, jobs[i].filename);
+            } });
+    }
 
-            // Save the image or process it further
-            saveImageToFile(image, sectionDirectoryName + "/" + studentName + " (" + studentID + ").png");
+    try
+    {
+        pool.wait();
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << '\n';
+        pause();
+        return 1;
+    }
+
+    // Removes the images of the students that were removed or renamed
+    std::size_t removedNum = 0;
+    for (const auto &stalePath : previousManifest.stalePaths(manifest))
+    {
+        std::error_code error;
+        if (fs::remove(stalePath, error))
+        {
+            removedNum++;
         }
     }
 
+    manifest.save(manifestFilename);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    std::cout << "Generated " << jobs.size() << " QR codes in " << elapsed.count() << " seconds using " << pool.size() << " threads." << std::endl;
+    std::cout << unchangedNum << " unchanged, " << removedNum << " removed." << std::endl;
+
     pause();
     return 0;
-}
\ No newline at end of file
+}
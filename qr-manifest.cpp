@@ -0,0 +1,102 @@
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "qr-manifest.hpp"
+#include "utils.hpp"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+// Bumped whenever the hashed content or the rasterizer output changes,
+// so that every image gets regenerated
+static const int manifestVersion = 1;
+
+QRManifest QRManifest::load(const std::string &filename)
+{
+    QRManifest manifest;
+
+    std::ifstream input(filename);
+    if (!input.is_open())
+    {
+        return manifest;
+    }
+
+    json data = json::parse(input, nullptr, false);
+    if (data.is_discarded() || data.value("version", 0) != manifestVersion || !data.contains("images"))
+    {
+        return manifest;
+    }
+
+    for (auto &image : data["images"].items())
+    {
+        // An unreadable entry only means that the image gets regenerated
+        try
+        {
+            manifest.images[image.key()] = std::stoull(image.value().get<std::string>(), nullptr, 16);
+        }
+        catch (const std::exception &)
+        {
+        }
+    }
+    return manifest;
+}
+
+bool QRManifest::save(const std::string &filename) const
+{
+    json imagesData = json::object();
+    for (const auto &image : images)
+    {
+        std::ostringstream hash;
+        hash << std::hex << image.second;
+        imagesData[image.first] = hash.str();
+    }
+
+    std::ofstream output(filename);
+    if (!output.is_open())
+    {
+        std::cerr << "Error: Unable to write " << filename << std::endl;
+        return false;
+    }
+    output << std::setw(2) << json{{"version", manifestVersion}, {"images", imagesData}} << std::endl;
+    return true;
+}
+
+bool QRManifest::isUpToDate(const std::string &imagePath, std::uint64_t contentHash) const
+{
+    auto iterator = images.find(imagePath);
+    return iterator != images.end() && iterator->second == contentHash && fs::exists(imagePath);
+}
+
+void QRManifest::set(const std::string &imagePath, std::uint64_t contentHash)
+{
+    images[imagePath] = contentHash;
+}
+
+std::vector<std::string> QRManifest::stalePaths(const QRManifest &current) const
+{
+    std::vector<std::string> paths;
+    for (const auto &image : images)
+    {
+        if (current.images.find(image.first) == current.images.end())
+        {
+            paths.push_back(image.first);
+        }
+    }
+    return paths;
+}
+
+std::uint64_t qrContentHash(const std::string &studentID, const std::string &studentName, const RasterOptions &options)
+{
+    std::ostringstream content;
+    content << studentID << '\n'
+            << studentName << '\n'
+            << options.scale << ' ' << options.targetSize << ' ' << options.quietZone;
+    return fnv1aHash(content.str());
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "qr-raster.hpp"
+
+// Record of the QR code images that were generated, and a hash of what was
+// encoded into each of them (ID, name and encoding parameters)
+// Structure:
+//      {
+//          "version": 1,
+//          "images": {
+//              [image path]: [hash]
+//          }
+//      }
+class QRManifest
+{
+public:
+    // Returns an empty manifest if the file does not exist or cannot be read
+    static QRManifest load(const std::string &filename);
+
+    bool save(const std::string &filename) const;
+
+    // True if the image was generated from the same content and is still on disk
+    bool isUpToDate(const std::string &imagePath, std::uint64_t contentHash) const;
+
+    void set(const std::string &imagePath, std::uint64_t contentHash);
+
+    // Images listed in this manifest that are not in `current`
+    std::vector<std::string> stalePaths(const QRManifest &current) const;
+
+private:
+    std::unordered_map<std::string, std::uint64_t> images;
+};
+
+std::uint64_t qrContentHash(const std::string &studentID, const std::string &studentName, const RasterOptions &options);
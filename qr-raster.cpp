@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include <opencv2/core.hpp>
+#include "BarcodeFormat.h"
+#include "BitMatrix.h"
+#include "MultiFormatWriter.h"
+
+#include "qr-raster.hpp"
+
+ZXing::MultiFormatWriter createModuleWriter(ZXing::BarcodeFormat format)
+{
+    ZXing::MultiFormatWriter writer(format);
+    writer.setMargin(0);
+    return writer;
+}
+
+ZXing::BitMatrix encodeModules(const ZXing::MultiFormatWriter &writer, const std::string &text)
+{
+    // A requested size of 0 gives the smallest matrix, one bit per module
+    return writer.encode(text, 0, 0);
+}
+
+cv::Mat rasterizeModules(const ZXing::BitMatrix &modules, const RasterOptions &options)
+{
+    const int modulesWidth = modules.width();
+    const int modulesHeight = modules.height();
+    const int quietZone = std::max(0, options.quietZone);
+
+    int scale = options.scale;
+    if (scale <= 0)
+    {
+        scale = std::max(1, options.targetSize / (std::max(modulesWidth, modulesHeight) + 2 * quietZone));
+    }
+
+    const int width = (modulesWidth + 2 * quietZone) * scale;
+    const int height = (modulesHeight + 2 * quietZone) * scale;
+
+    // Starts all white, so only the dark modules have to be filled
+    cv::Mat image(height, width, CV_8UC1, cv::Scalar(255));
+
+    const int offset = quietZone * scale;
+    for (int y = 0; y < modulesHeight; ++y)
+    {
+        uchar *firstRow = image.ptr(offset + y * scale);
+
+        // Fills each run of dark modules with a single memset
+        int x = 0;
+        while (x < modulesWidth)
+        {
+            if (!modules.get(x, y))
+            {
+                ++x;
+                continue;
+            }
+            int runStart = x;
+            while (x < modulesWidth && modules.get(x, y))
+            {
+                ++x;
+            }
+            std::memset(firstRow + offset + runStart * scale, 0, static_cast<std::size_t>(x - runStart) * scale);
+        }
+
+        // The other pixel rows of the module are the same
+        for (int repeat = 1; repeat < scale; ++repeat)
+        {
+            std::memcpy(image.ptr(offset + y * scale + repeat), firstRow, width);
+        }
+    }
+
+    return image;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+
+#include <opencv2/core.hpp>
+#include "BitMatrix.h"
+#include "MultiFormatWriter.h"
+
+struct RasterOptions
+{
+    // Pixels per module. 0 picks the largest scale that fits in `targetSize`
+    int scale = 0;
+
+    // Size (in pixels) the image should fit in when `scale` is 0
+    int targetSize = 300;
+
+    // Width of the white border around the code, in modules
+    // (the QR code specification asks for at least 4)
+    int quietZone = 4;
+};
+
+// Creates a writer that encodes to the bare module grid (one bit per module,
+// no margin), which is what `rasterizeModules` expects
+ZXing::MultiFormatWriter createModuleWriter(ZXing::BarcodeFormat format);
+
+// Encodes `text` to its module grid
+ZXing::BitMatrix encodeModules(const ZXing::MultiFormatWriter &writer, const std::string &text);
+
+// Converts a module grid to a grayscale image (dark modules are black)
+// Each module row is filled once with runs of memset, then the row is copied
+// to the other pixel rows of the module, so the matrix is only read once
+// per module instead of once per pixel
+cv::Mat rasterizeModules(const ZXing::BitMatrix &modules, const RasterOptions &options = {});
@@ -0,0 +1,271 @@
+// Microbenchmarks of the scanning and saving hot paths, on synthetic data
+//
+// Usage: qrar-bench [--benchmark_filter=REGEX] [--benchmark_out=FILE --benchmark_out_format=json]
+//
+// The roster sizes are the benchmark arguments (ex. BM_RosterLookup/10000
+// uses 10000 students). The JSON output can be kept per commit and compared
+// with the compare.py tool of Google Benchmark to track regressions
+
+#include <filesystem>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <opencv2/opencv.hpp>
+#include "ReadBarcode.h"
+#include "DecodeHints.h"
+#include <nlohmann/json.hpp>
+
+#include "roster.hpp"
+#include "attendance-records.hpp"
+#include "attendance-store.hpp"
+#include "excel-exporter.hpp"
+#include "roi-tracker.hpp"
+#include "scanner-config.hpp"
+#include "qr-raster.hpp"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+static const std::vector<std::string> &modes = attendanceModes();
+
+// Students per section of the synthetic rosters
+static const int studentsPerSection = 40;
+
+static std::string syntheticID(int student)
+{
+    return std::to_string(2020000000 + student);
+}
+
+// students-data.json with `studentsNum` students, 40 per section
+static json syntheticStudentsData(int studentsNum)
+{
+    json studentsData = json::object();
+    for (int student = 0; student < studentsNum; ++student)
+    {
+        std::string section = "BSCS " + std::to_string(student / studentsPerSection + 1) + "A";
+        studentsData[section].push_back({{"name", "Student " + std::to_string(student)}, {"id", syntheticID(student)}});
+    }
+    return studentsData;
+}
+
+// backup.json where every student was scanned in every mode of `datesNum` days
+static json syntheticBackup(const json &studentsData, int datesNum)
+{
+    json backupData = {{"attendance", json::object()}};
+    for (int day = 0; day < datesNum; ++day)
+    {
+        std::string date = "Mon 01-" + std::string(day < 9 ? "0" : "") + std::to_string(day + 1) + "-2024";
+        for (auto &section : studentsData.items())
+        {
+            for (const auto &mode : modes)
+            {
+                json &recordsByID = backupData["attendance"][date][section.key()][mode];
+                for (const auto &student : section.value())
+                {
+                    recordsByID[student["id"].get<std::string>()] = "07:30";
+                }
+            }
+        }
+    }
+    return backupData;
+}
+
+// A 640x480 camera-like frame (noisy gray background, BGR) with the QR code
+// of `text` in it, encoded like qr-code-generator does
+static cv::Mat syntheticFrame(const std::string &text)
+{
+    ZXing::MultiFormatWriter writer = createModuleWriter(ZXing::BarcodeFormat::QRCode);
+    RasterOptions rasterOptions;
+    rasterOptions.scale = 4;
+    cv::Mat code = rasterizeModules(encodeModules(writer, text), rasterOptions);
+
+    cv::Mat gray(480, 640, CV_8UC1);
+    cv::randn(gray, cv::Scalar(160), cv::Scalar(20));
+    code.copyTo(gray(cv::Rect((gray.cols - code.cols) / 2, (gray.rows - code.rows) / 2, code.cols, code.rows)));
+
+    cv::Mat frame;
+    cv::cvtColor(gray, frame, cv::COLOR_GRAY2BGR);
+    return frame;
+}
+
+static void BM_RosterBuild(benchmark::State &state)
+{
+    json studentsData = syntheticStudentsData(static_cast<int>(state.range(0)));
+    for (auto _ : state)
+    {
+        Roster roster = Roster::fromStudentsData(studentsData);
+        benchmark::DoNotOptimize(roster);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RosterBuild)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMicrosecond);
+
+// Half of the looked up IDs are registered, like a gate with visitors
+static void BM_RosterLookup(benchmark::State &state)
+{
+    int studentsNum = static_cast<int>(state.range(0));
+    Roster roster = Roster::fromStudentsData(syntheticStudentsData(studentsNum));
+
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> studentDistribution(0, 2 * studentsNum - 1);
+    std::vector<std::string> scannedIDs;
+    for (int i = 0; i < 4096; ++i)
+    {
+        scannedIDs.push_back(syntheticID(studentDistribution(random)));
+    }
+
+    std::size_t next = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(roster.find(scannedIDs[next]));
+        next = (next + 1) % scannedIDs.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RosterLookup)->RangeMultiplier(10)->Range(100, 100000);
+
+// One frame through the decoder, with the default scanner configuration.
+// Argument 0 decodes the whole frame, 1 goes through the ROI tracker (the
+// window around the code is decoded, with a full scan every 10 frames)
+static void BM_DecodeFrame(benchmark::State &state)
+{
+    ScannerConfig config;
+    config.pipeline.roi.enabled = state.range(0) != 0;
+    ZXing::DecodeHints hints = buildDecodeHints(config);
+    RoiTracker tracker(config.pipeline.roi);
+    cv::Mat frame = syntheticFrame(syntheticID(1));
+
+    for (auto _ : state)
+    {
+        TrackedResults tracked = tracker.decode(frame, hints);
+        if (tracked.results.empty())
+        {
+            state.SkipWithError("The synthetic code was not decoded");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DecodeFrame)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// backup.bin as written at the end of a session (Phase 5)
+static void BM_BackupSerialize(benchmark::State &state)
+{
+    AttendanceRecords records = AttendanceRecords::fromJson(syntheticBackup(syntheticStudentsData(static_cast<int>(state.range(0))), 5));
+    std::size_t bytes = 0;
+    for (auto _ : state)
+    {
+        std::string data = records.serialize();
+        bytes = data.size();
+        benchmark::DoNotOptimize(data);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes));
+}
+BENCHMARK(BM_BackupSerialize)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+
+// backup.bin as read at the start of a session (Phase 2)
+static void BM_BackupParse(benchmark::State &state)
+{
+    AttendanceRecords records = AttendanceRecords::fromJson(syntheticBackup(syntheticStudentsData(static_cast<int>(state.range(0))), 5));
+    std::string data = records.serialize();
+    for (auto _ : state)
+    {
+        AttendanceRecords parsed;
+        if (!AttendanceRecords::deserialize(data, parsed))
+        {
+            state.SkipWithError("Invalid snapshot");
+            break;
+        }
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK(BM_BackupParse)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+
+// The same data as backup.json (--export-json and the import of older
+// versions), for comparison with the binary snapshot
+static void BM_BackupJsonSerialize(benchmark::State &state)
+{
+    json backupData = syntheticBackup(syntheticStudentsData(static_cast<int>(state.range(0))), 5);
+    std::size_t bytes = 0;
+    for (auto _ : state)
+    {
+        std::ostringstream output;
+        output << std::setw(4) << backupData << std::endl;
+        bytes = output.str().size();
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes));
+}
+BENCHMARK(BM_BackupJsonSerialize)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+
+static void BM_BackupJsonParse(benchmark::State &state)
+{
+    json backupData = syntheticBackup(syntheticStudentsData(static_cast<int>(state.range(0))), 5);
+    std::string text = backupData.dump(4);
+    for (auto _ : state)
+    {
+        json parsed = json::parse(text);
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_BackupJsonParse)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+
+// Phases 6 and 7 on a new workbook: one sheet per section with the date,
+// ID and name headers, then one time cell per record, then saving
+static void BM_WorkbookWrite(benchmark::State &state)
+{
+    json studentsData = syntheticStudentsData(static_cast<int>(state.range(0)));
+    Roster roster = Roster::fromStudentsData(studentsData);
+    AttendanceRecords records = AttendanceRecords::fromJson(syntheticBackup(studentsData, 1));
+    std::string excelFilename = (fs::temp_directory_path() / "qrar-bench.xlsx").string();
+
+    for (auto _ : state)
+    {
+        fs::remove(excelFilename);
+        ExcelExporter exporter(roster, modes);
+        exporter.open(excelFilename);
+        exporter.writeHeaders(records);
+        if (!exporter.writeTimes(records))
+        {
+            state.SkipWithError("A header is missing");
+            break;
+        }
+        exporter.save();
+        exporter.close();
+    }
+    fs::remove(excelFilename);
+    fs::remove(excelFilename + ".qrar-export.json");
+    state.SetItemsProcessed(state.iterations() * state.range(0) * static_cast<std::int64_t>(modes.size()));
+}
+BENCHMARK(BM_WorkbookWrite)->RangeMultiplier(10)->Range(100, 1000)->Unit(benchmark::kMillisecond);
+
+// The same workbook written in one pass by the streaming writer (--full-rebuild)
+static void BM_WorkbookRebuild(benchmark::State &state)
+{
+    json studentsData = syntheticStudentsData(static_cast<int>(state.range(0)));
+    Roster roster = Roster::fromStudentsData(studentsData);
+    AttendanceRecords records = AttendanceRecords::fromJson(syntheticBackup(studentsData, 1));
+    std::string excelFilename = (fs::temp_directory_path() / "qrar-bench.xlsx").string();
+
+    for (auto _ : state)
+    {
+        ExcelExporter exporter(roster, modes);
+        if (!exporter.rebuild(excelFilename, records))
+        {
+            state.SkipWithError("Could not write the workbook");
+            break;
+        }
+    }
+    fs::remove(excelFilename);
+    fs::remove(excelFilename + ".qrar-export.json");
+    state.SetItemsProcessed(state.iterations() * state.range(0) * static_cast<std::int64_t>(modes.size()));
+}
+BENCHMARK(BM_WorkbookRebuild)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
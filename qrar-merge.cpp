@@ -0,0 +1,318 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "utils.hpp"
+#include "attendance-records.hpp"
+#include "attendance-store.hpp"
+#include "event-log.hpp"
+#include "excel-exporter.hpp"
+#include "roster.hpp"
+
+// Merges the event logs of several stations (see event-log.hpp) into one
+// attendance data, as if every scan had been recorded by a single station
+//
+// The logs are read in one pass, each from the start to the end, and merged
+// by timestamp (k-way merge with a heap of the next event of each input). The
+// first scan of a student per date/section/mode wins, so a student scanned
+// at two gates keeps the earliest scan. Each log is already in time order,
+// so the merge is O(n log k) for n events in k logs and only the next event
+// of each log is held besides the merged records
+//
+// Snapshots (backup.bin, or backup.json of older versions) are accepted as
+// inputs too, for the scans recorded before the stations kept event logs,
+// and for the scans a station recovered from its journal after a crash that
+// its event log lost. Their scans only have a date and a minute, so they are
+// timestamped at the start of that minute (in the local time zone of this
+// computer, which should be the stations' one), and sorted in memory
+
+// A time-ordered source of scans
+class MergeInput
+{
+public:
+    virtual ~MergeInput() = default;
+
+    // Reads the next scan. Returns false at the end of the input
+    virtual bool next(StationEvent &stationEvent) = 0;
+
+    // Number of entries of the input that are not valid scans
+    virtual std::size_t skippedEntries() const = 0;
+};
+
+class EventLogInput : public MergeInput
+{
+public:
+    bool open(const std::string &filename)
+    {
+        return reader.open(filename);
+    }
+
+    bool next(StationEvent &stationEvent) override
+    {
+        return reader.next(stationEvent);
+    }
+
+    std::size_t skippedEntries() const override
+    {
+        return reader.skippedLines();
+    }
+
+private:
+    EventLogReader reader;
+};
+
+// Milliseconds since the Unix epoch of the start of the minute of a scan,
+// from its date ("%a %m-%d-%Y") and time. Scans with a date that cannot be
+// read come last, so they lose to any other scan of the same student
+static std::int64_t scanTimestamp(const std::string &date, std::uint16_t minutes)
+{
+    int month, day, year;
+    if (std::sscanf(date.c_str(), "%*s %d-%d-%d", &month, &day, &year) != 3)
+    {
+        return INT64_MAX;
+    }
+
+    std::tm localTime{};
+    localTime.tm_year = year - 1900;
+    localTime.tm_mon = month - 1;
+    localTime.tm_mday = day;
+    localTime.tm_hour = minutes / 60;
+    localTime.tm_min = minutes % 60;
+    localTime.tm_isdst = -1;
+    std::time_t time = std::mktime(&localTime);
+    return time == static_cast<std::time_t>(-1) ? INT64_MAX : static_cast<std::int64_t>(time) * 1000;
+}
+
+class SnapshotInput : public MergeInput
+{
+public:
+    // Reads a snapshot of backup.bin, or a backup.json if the name ends with ".json"
+    bool open(const std::string &filename)
+    {
+        station = filename;
+        std::ifstream input(filename, std::ios::binary);
+        if (!input.is_open())
+        {
+            return false;
+        }
+
+        if (endsWith(filename, ".json"))
+        {
+            try
+            {
+                records = AttendanceRecords::fromJson(nlohmann::json::parse(input));
+            }
+            catch (const nlohmann::json::exception &e)
+            {
+                std::cerr << "Error: Unable to read " << filename << ": " << e.what() << std::endl;
+                return false;
+            }
+        }
+        else
+        {
+            std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+            if (!AttendanceRecords::deserialize(data, records))
+            {
+                std::cerr << "Error: " << filename << " is damaged or was written by a newer version." << std::endl;
+                return false;
+            }
+        }
+
+        // The records are in the order they were stored, which is not the
+        // time order for the imported ones, so they are sorted
+        const std::vector<AttendanceRecord> &recordList = records.records();
+        order.reserve(recordList.size());
+        for (std::size_t i = 0; i < recordList.size(); ++i)
+        {
+            order.emplace_back(scanTimestamp(std::string(records.text(recordList[i].date)), recordList[i].minutes), i);
+        }
+        std::stable_sort(order.begin(), order.end());
+        return true;
+    }
+
+    bool next(StationEvent &stationEvent) override
+    {
+        if (position == order.size())
+        {
+            return false;
+        }
+        stationEvent.timestamp = order[position].first;
+        stationEvent.station = station;
+        stationEvent.event = records.event(records.records()[order[position].second]);
+        position++;
+        return true;
+    }
+
+    std::size_t skippedEntries() const override
+    {
+        return 0;
+    }
+
+private:
+    std::string station;
+    AttendanceRecords records;
+    std::vector<std::pair<std::int64_t, std::size_t>> order;
+    std::size_t position = 0;
+};
+
+int main(int argc, char *argv[])
+{
+    // Usage: qrar-merge [--output FILE] [--excel FILE] [--export-json FILE] [--students FILE] INPUT...
+    //      --output        merged snapshot, in the format of backup.bin (default: merged.bin)
+    //      --excel         also writes the merged attendance to this excel file, replacing it
+    //      --export-json   also writes it in the structure of backup.json
+    //      --students      students data used for the excel file (default: students-data.json)
+    //      INPUT           event logs of the stations (events-[station].log), or
+    //                      snapshots of their attendance data (*.bin, or *.json of older versions)
+    std::string outputFilename = getOptionValue(argc, argv, "--output", "merged.bin");
+    std::string excelFilename = getOptionValue(argc, argv, "--excel", "");
+    std::string exportJsonFilename = getOptionValue(argc, argv, "--export-json", "");
+    std::string studentsDataFilename = getOptionValue(argc, argv, "--students", "students-data.json");
+
+    std::vector<std::string> inputFilenames;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (argument == "--output" || argument == "--excel" || argument == "--export-json" || argument == "--students")
+        {
+            ++i; // Skips the option's value
+            continue;
+        }
+        inputFilenames.push_back(argument);
+    }
+    if (inputFilenames.empty())
+    {
+        std::cerr << "Usage: qrar-merge [--output FILE] [--excel FILE] [--export-json FILE] [--students FILE] INPUT..." << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::unique_ptr<MergeInput>> readers;
+    for (const auto &filename : inputFilenames)
+    {
+        bool opened;
+        if (endsWith(filename, ".bin") || endsWith(filename, ".json"))
+        {
+            auto snapshot = std::make_unique<SnapshotInput>();
+            opened = snapshot->open(filename);
+            readers.push_back(std::move(snapshot));
+        }
+        else
+        {
+            auto eventLog = std::make_unique<EventLogInput>();
+            opened = eventLog->open(filename);
+            readers.push_back(std::move(eventLog));
+        }
+        if (!opened)
+        {
+            std::cerr << "Error: Unable to open " << filename << std::endl;
+            return 1;
+        }
+    }
+
+    // The next event of each input, and the heap of (timestamp, input) of these
+    // events, earliest first. Equal timestamps are taken in the order of the inputs
+    std::vector<StationEvent> nextEvents(readers.size());
+    using HeapEntry = std::tuple<std::int64_t, std::size_t>;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+    for (std::size_t i = 0; i < readers.size(); ++i)
+    {
+        if (readers[i]->next(nextEvents[i]))
+        {
+            heap.emplace(nextEvents[i].timestamp, i);
+        }
+    }
+
+    AttendanceRecords records;
+    std::size_t eventsNum = 0;
+    std::size_t duplicatesNum = 0;
+    while (!heap.empty())
+    {
+        std::size_t log = std::get<1>(heap.top());
+        heap.pop();
+
+        eventsNum++;
+        if (!records.add(nextEvents[log].event))
+        {
+            duplicatesNum++; // Already recorded by an earlier scan (or an invalid time)
+        }
+
+        if (readers[log]->next(nextEvents[log]))
+        {
+            heap.emplace(nextEvents[log].timestamp, log);
+        }
+    }
+
+    for (std::size_t i = 0; i < readers.size(); ++i)
+    {
+        if (readers[i]->skippedEntries() > 0)
+        {
+            std::cout << "Skipped " << readers[i]->skippedEntries() << " invalid lines of " << inputFilenames[i] << std::endl;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Merged " << eventsNum << " scans from " << inputFilenames.size() << " inputs into " << records.size()
+              << " records (" << duplicatesNum << " duplicates) in " << seconds << " s." << std::endl;
+
+    if (!writeFileAtomically(outputFilename, records.serialize()))
+    {
+        return 1;
+    }
+    std::cout << "Wrote " << outputFilename << std::endl;
+
+    if (!exportJsonFilename.empty())
+    {
+        std::string text = records.toJson().dump(4);
+        text += '\n';
+        if (!writeFileAtomically(exportJsonFilename, text))
+        {
+            return 1;
+        }
+        std::cout << "Wrote " << exportJsonFilename << std::endl;
+    }
+
+    if (!excelFilename.empty())
+    {
+        Roster roster;
+        try
+        {
+            roster = Roster::fromFile(studentsDataFilename);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+
+        ExcelExporter exporter(roster, attendanceModes());
+        std::vector<std::string> unregisteredIDs = exporter.findUnregisteredIDs(records);
+        if (!unregisteredIDs.empty())
+        {
+            for (const auto &id : unregisteredIDs)
+            {
+                std::cout << "Student with the ID " << id << " is not registered on the system." << std::endl;
+            }
+            std::cout << "You can use the students-data.exe program to register students." << std::endl;
+            return 1;
+        }
+        if (!exporter.rebuild(excelFilename, records))
+        {
+            return 1;
+        }
+        std::cout << "Wrote " << excelFilename << std::endl;
+    }
+
+    return 0;
+}
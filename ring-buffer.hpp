@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Bounded, lock-free, multi-producer/multi-consumer queue
+// Each slot carries a sequence number that tells producers and consumers
+// whether the slot is free to be written or ready to be read, so pushing
+// and popping only needs one compare-and-swap on the shared position
+// The capacity is rounded up to the next power of two
+template <typename T>
+class RingBuffer
+{
+public:
+    explicit RingBuffer(std::size_t capacity);
+
+    RingBuffer(const RingBuffer &) = delete;
+    RingBuffer &operator=(const RingBuffer &) = delete;
+
+    // Returns false (and leaves `value` untouched) if the buffer is full
+    bool tryPush(T &&value);
+
+    // Returns false if the buffer is empty
+    bool tryPop(T &value);
+
+    std::size_t capacity() const;
+
+private:
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    // Keeps the producer and consumer positions on separate cache lines
+    static constexpr std::size_t cacheLineSize = 64;
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask;
+
+    alignas(cacheLineSize) std::atomic<std::size_t> enqueuePosition;
+    alignas(cacheLineSize) std::atomic<std::size_t> dequeuePosition;
+};
+
+#include "ring-buffer.tpp"
@@ -0,0 +1,100 @@
+template <typename T>
+RingBuffer<T>::RingBuffer(std::size_t capacity)
+    : enqueuePosition(0), dequeuePosition(0)
+{
+    // Rounds the capacity up to a power of two so that the slot
+    // index can be computed with a mask instead of a modulo
+    std::size_t size = 2;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    slots.reset(new Slot[size]);
+    mask = size - 1;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+bool RingBuffer<T>::tryPush(T &&value)
+{
+    std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+    Slot *slot;
+
+    while (true)
+    {
+        slot = &slots[position & mask];
+        std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if (difference == 0)
+        {
+            // The slot is free, try to claim it
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The slot still holds a value that was not consumed yet
+            return false;
+        }
+        else
+        {
+            // Another producer claimed the slot first
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->value = std::move(value);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool RingBuffer<T>::tryPop(T &value)
+{
+    std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+    Slot *slot;
+
+    while (true)
+    {
+        slot = &slots[position & mask];
+        std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+        if (difference == 0)
+        {
+            // The slot holds a value, try to claim it
+            if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // Nothing was pushed to the slot yet
+            return false;
+        }
+        else
+        {
+            // Another consumer claimed the slot first
+            position = dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    value = std::move(slot->value);
+    slot->sequence.store(position + mask + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+std::size_t RingBuffer<T>::capacity() const
+{
+    return mask + 1;
+}
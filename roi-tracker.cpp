@@ -0,0 +1,146 @@
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+#include "ZXingOpenCV.h"
+#include "ReadBarcode.h"
+#include "DecodeHints.h"
+
+#include "roi-tracker.hpp"
+#include "scan-dedup.hpp"
+
+RoiTracker::RoiTracker(RoiOptions options)
+    : options(options)
+{
+}
+
+TrackedResults RoiTracker::decode(const cv::Mat &frame, const ZXing::DecodeHints &hints)
+{
+    cv::Rect wholeFrame(0, 0, frame.cols, frame.rows);
+    if (!options.enabled)
+    {
+        return decodeArea(frame, wholeFrame, hints);
+    }
+
+    bool fullScanDue = ++framesSinceFullScan >= options.fullScanInterval;
+
+    // [1] Decodes the window around the last detection
+    if (!fullScanDue && !window.empty())
+    {
+        TrackedResults tracked = decodeArea(frame, window, hints);
+        if (!tracked.results.empty())
+        {
+            track(tracked, frame.size());
+            return tracked;
+        }
+        window = cv::Rect(); // The code left the window
+    }
+
+    // [2] Looks for codes in a downscaled copy, the small codes it
+    // misses are found by the next full scan
+    if (!fullScanDue && options.prepassScale > 0)
+    {
+        TrackedResults tracked = decodePrepass(frame, hints);
+        track(tracked, frame.size());
+        return tracked;
+    }
+
+    // [3] Decodes the whole frame at full resolution
+    framesSinceFullScan = 0;
+    TrackedResults tracked = decodeArea(frame, wholeFrame, hints);
+    track(tracked, frame.size());
+    return tracked;
+}
+
+void RoiTracker::draw(cv::Mat &frame, const TrackedResults &tracked)
+{
+    if (tracked.fromPrepass)
+    {
+        // The positions are in the coordinates of the downscaled image
+        if (!tracked.detectedRegion.empty())
+        {
+            cv::rectangle(frame, tracked.detectedRegion, cv::Scalar(0, 255, 0), 2);
+        }
+        return;
+    }
+
+    // A view of the decoded area, so that the relative positions land in place
+    cv::Mat area = frame(tracked.decodedArea);
+    for (const auto &r : tracked.results)
+    {
+        DrawResult(area, r);
+    }
+}
+
+TrackedResults RoiTracker::decodeArea(const cv::Mat &frame, const cv::Rect &area, const ZXing::DecodeHints &hints)
+{
+    TrackedResults tracked;
+    tracked.decodedArea = area;
+
+    if (area.width == frame.cols && area.height == frame.rows)
+    {
+        tracked.results = ReadBarcodes(frame, hints);
+    }
+    else
+    {
+        // ZXingOpenCV reads the image as a continuous buffer (it ignores the
+        // row stride of a view), so the window is copied first. The copy is
+        // small compared to decoding the whole frame
+        tracked.results = ReadBarcodes(frame(area).clone(), hints);
+    }
+
+    tracked.detectedRegion = resultsBoundingBox(tracked.results, area.size());
+    if (!tracked.detectedRegion.empty())
+    {
+        tracked.detectedRegion.x += area.x;
+        tracked.detectedRegion.y += area.y;
+    }
+    return tracked;
+}
+
+TrackedResults RoiTracker::decodePrepass(const cv::Mat &frame, const ZXing::DecodeHints &hints)
+{
+    cv::Mat gray;
+    if (frame.channels() == 1)
+    {
+        gray = frame;
+    }
+    else
+    {
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    }
+
+    cv::Mat small;
+    cv::resize(gray, small, cv::Size(), options.prepassScale, options.prepassScale, cv::INTER_AREA);
+
+    TrackedResults tracked;
+    tracked.fromPrepass = true;
+    tracked.decodedArea = cv::Rect(0, 0, frame.cols, frame.rows);
+    tracked.results = ReadBarcodes(small, hints);
+
+    // Scales the detection back to the frame's coordinates
+    cv::Rect region = resultsBoundingBox(tracked.results, small.size());
+    if (!region.empty())
+    {
+        region = cv::Rect(static_cast<int>(region.x / options.prepassScale),
+                          static_cast<int>(region.y / options.prepassScale),
+                          static_cast<int>(region.width / options.prepassScale) + 1,
+                          static_cast<int>(region.height / options.prepassScale) + 1);
+        tracked.detectedRegion = region & tracked.decodedArea;
+    }
+    return tracked;
+}
+
+void RoiTracker::track(const TrackedResults &tracked, const cv::Size &frameSize)
+{
+    const cv::Rect &region = tracked.detectedRegion;
+    if (region.empty())
+    {
+        window = cv::Rect();
+        return;
+    }
+
+    int marginX = static_cast<int>(region.width * options.margin);
+    int marginY = static_cast<int>(region.height * options.margin);
+    window = cv::Rect(region.x - marginX, region.y - marginY, region.width + 2 * marginX, region.height + 2 * marginY) &
+             cv::Rect(0, 0, frameSize.width, frameSize.height);
+}
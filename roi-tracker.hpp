@@ -0,0 +1,62 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include "DecodeHints.h"
+#include "ReadBarcode.h"
+
+struct RoiOptions
+{
+    bool enabled = true;
+
+    // Space added around the last detection on each side, as a fraction
+    // of the detection's size, so that a moving card stays in the window
+    double margin = 0.5;
+
+    // Every this many frames the whole frame is decoded at full resolution,
+    // to find codes outside of the window or too small for the pre-pass
+    int fullScanInterval = 10;
+
+    // Scale of the grayscale pre-pass used to find codes when there is no
+    // window yet (ex. 0.5 decodes a half size image). 0 disables it
+    double prepassScale = 0;
+};
+
+// Where the codes of a decoded frame are, and where to draw them
+struct TrackedResults
+{
+    ZXing::Results results;
+
+    // Area of the frame the results were decoded from. The positions of
+    // the results are relative to it (its top-left corner)
+    cv::Rect decodedArea;
+
+    // Smallest rectangle holding every detection (in frame coordinates),
+    // empty if nothing was found
+    cv::Rect detectedRegion;
+
+    // True if the results come from the downscaled pre-pass, their
+    // positions are then in the coordinates of the downscaled image
+    bool fromPrepass = false;
+};
+
+// Decodes only a window around the last detection, since a card usually
+// stays around the same place for several frames
+class RoiTracker
+{
+public:
+    explicit RoiTracker(RoiOptions options = {});
+
+    TrackedResults decode(const cv::Mat &frame, const ZXing::DecodeHints &hints);
+
+    // Draws the results on the frame (from ZXingOpenCV)
+    static void draw(cv::Mat &frame, const TrackedResults &tracked);
+
+private:
+    TrackedResults decodeArea(const cv::Mat &frame, const cv::Rect &area, const ZXing::DecodeHints &hints);
+    TrackedResults decodePrepass(const cv::Mat &frame, const ZXing::DecodeHints &hints);
+    void track(const TrackedResults &tracked, const cv::Size &frameSize);
+
+    RoiOptions options;
+    cv::Rect window;
+    int framesSinceFullScan = 0;
+};
@@ -0,0 +1,149 @@
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "roster.hpp"
+#include "utils.hpp"
+
+using json = nlohmann::json;
+
+Roster Roster::fromFile(const std::string &filename)
+{
+    std::ifstream f(filename);
+    if (!f.is_open())
+    {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+
+    try
+    {
+        return fromStudentsData(json::parse(f));
+    }
+    catch (const json::exception &e)
+    {
+        throw std::runtime_error("Invalid students data " + filename + ": " + e.what());
+    }
+}
+
+Roster Roster::fromStudentsData(const json &studentsData)
+{
+    Roster roster;
+
+    std::size_t studentsNum = 0;
+    for (auto &sectionData : studentsData.items())
+    {
+        studentsNum += sectionData.value().size();
+    }
+    roster.records.reserve(studentsNum);
+    roster.strings.reserve(studentsNum * 2 + studentsData.size(), studentsNum * 32);
+
+    for (auto &sectionData : studentsData.items())
+    {
+        const std::string &section = sectionData.key();
+        if (!isInVector(roster.sectionNames, section))
+        {
+            roster.sectionNames.push_back(section);
+        }
+        StringInterner::Symbol courseAndSection = roster.strings.intern(section);
+
+        for (const auto &studentObject : sectionData.value())
+        {
+            roster.add(studentObject["id"].get_ref<const std::string &>(),
+                       studentObject["name"].get_ref<const std::string &>(),
+                       courseAndSection);
+        }
+    }
+
+    roster.buildIndex();
+    return roster;
+}
+
+const StudentRecord *Roster::find(std::string_view id) const
+{
+    // IDs that were never interned cannot belong to a student
+    StringInterner::Symbol symbol = strings.find(id);
+    if (symbol == StringInterner::noSymbol || idSlots.empty())
+    {
+        return nullptr;
+    }
+
+    std::size_t mask = idSlots.size() - 1;
+    std::size_t slot = fnv1aHash(id) & mask;
+    while (idSlots[slot] != emptySlot)
+    {
+        const StudentRecord &student = records[idSlots[slot]];
+        if (student.id == symbol)
+        {
+            return &student;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return nullptr;
+}
+
+std::string_view Roster::id(const StudentRecord &student) const
+{
+    return strings.view(student.id);
+}
+
+std::string_view Roster::name(const StudentRecord &student) const
+{
+    return strings.view(student.name);
+}
+
+std::string_view Roster::courseAndSection(const StudentRecord &student) const
+{
+    return strings.view(student.courseAndSection);
+}
+
+const std::vector<std::string> &Roster::sections() const
+{
+    return sectionNames;
+}
+
+const std::vector<StudentRecord> &Roster::students() const
+{
+    return records;
+}
+
+void Roster::add(std::string_view id, std::string_view name, StringInterner::Symbol courseAndSection)
+{
+    StringInterner::Symbol idSymbol = strings.intern(id);
+    StringInterner::Symbol nameSymbol = strings.intern(name);
+    records.push_back({idSymbol, nameSymbol, courseAndSection});
+}
+
+void Roster::buildIndex()
+{
+    // Keeps the table at most half full so that probe sequences stay short
+    std::size_t size = 16;
+    while (size < records.size() * 2)
+    {
+        size <<= 1;
+    }
+    idSlots.assign(size, emptySlot);
+
+    std::size_t mask = size - 1;
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        std::size_t slot = fnv1aHash(strings.view(records[i].id)) & mask;
+        bool alreadyIndexed = false;
+        while (idSlots[slot] != emptySlot)
+        {
+            if (records[idSlots[slot]].id == records[i].id)
+            {
+                alreadyIndexed = true; // Duplicate ID, the first one is kept
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+        if (!alreadyIndexed)
+        {
+            idSlots[slot] = static_cast<std::int32_t>(i);
+        }
+    }
+}
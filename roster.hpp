@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "string-interner.hpp"
+
+// One registered student. The fields are symbols of the roster's string pool
+struct StudentRecord
+{
+    StringInterner::Symbol id;
+    StringInterner::Symbol name;
+    StringInterner::Symbol courseAndSection;
+};
+
+// Read-only list of the registered students, built once from students-data.json
+// The records are stored contiguously and indexed by ID in an open-addressing
+// hash table, so finding a student by ID takes constant time
+class Roster
+{
+public:
+    // `studentsData` has the structure of students-data.json:
+    //      { [course_and_section]: [ { "name": [name], "id": [id] } ] }
+    static Roster fromStudentsData(const nlohmann::json &studentsData);
+
+    // Reads students-data.json. Throws std::runtime_error if it cannot be read
+    static Roster fromFile(const std::string &filename);
+
+    // Returns nullptr if no student has the ID. If an ID is registered
+    // more than once, the first registered student is returned
+    const StudentRecord *find(std::string_view id) const;
+
+    std::string_view id(const StudentRecord &student) const;
+    std::string_view name(const StudentRecord &student) const;
+    std::string_view courseAndSection(const StudentRecord &student) const;
+
+    // Section names in the order they appear in students-data.json
+    const std::vector<std::string> &sections() const;
+
+    const std::vector<StudentRecord> &students() const;
+
+private:
+    void add(std::string_view id, std::string_view name, StringInterner::Symbol courseAndSection);
+    void buildIndex();
+
+    static constexpr std::int32_t emptySlot = -1;
+
+    StringInterner strings;
+    std::vector<StudentRecord> records;
+    std::vector<std::string> sectionNames;
+
+    // Open-addressing (linear probing) table of record indices keyed by ID
+    std::vector<std::int32_t> idSlots;
+};
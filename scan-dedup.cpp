@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <bitset>
+#include <climits>
+
+#include <opencv2/opencv.hpp>
+#include "ReadBarcode.h"
+
+#include "scan-dedup.hpp"
+
+// Fingerprints this close are considered the same region
+static const int maxFingerprintDistance = 4;
+
+// How many checks happen between two removals of the expired IDs
+static const std::size_t pruneInterval = 1024;
+
+RecentScanCache::RecentScanCache(std::chrono::milliseconds window)
+    : window(window)
+{
+}
+
+bool RecentScanCache::seenRecently(const std::string &id, ScanClock::time_point now)
+{
+    // Removes the expired IDs once in a while, so the cache stays small
+    if (++checksSincePrune >= pruneInterval)
+    {
+        checksSincePrune = 0;
+        for (auto iterator = lastSeen.begin(); iterator != lastSeen.end();)
+        {
+            iterator = now - iterator->second > window ? lastSeen.erase(iterator) : std::next(iterator);
+        }
+    }
+
+    auto [iterator, inserted] = lastSeen.try_emplace(id, now);
+    if (inserted)
+    {
+        return false;
+    }
+
+    bool recent = now - iterator->second <= window;
+    iterator->second = now;
+    return recent;
+}
+
+RegionDedup::RegionDedup(std::chrono::milliseconds window, int maxSkippedFrames)
+    : window(window), maxSkippedFrames(maxSkippedFrames)
+{
+}
+
+bool RegionDedup::unchanged(const cv::Mat &frame, ScanClock::time_point now)
+{
+    if (!active || window.count() <= 0)
+    {
+        return false;
+    }
+
+    // Decodes again once in a while even if nothing moved
+    if (now - lastDecoded > window || skippedFrames >= maxSkippedFrames)
+    {
+        active = false;
+        return false;
+    }
+
+    if (fingerprintDistance(regionFingerprint(frame, lastRegion), lastFingerprint) > maxFingerprintDistance)
+    {
+        active = false;
+        return false;
+    }
+
+    skippedFrames++;
+    return true;
+}
+
+void RegionDedup::remember(const cv::Mat &frame, const cv::Rect &region, ScanClock::time_point now)
+{
+    if (region.empty())
+    {
+        active = false;
+        return;
+    }
+
+    active = true;
+    lastRegion = region;
+    lastFingerprint = regionFingerprint(frame, region);
+    lastDecoded = now;
+    skippedFrames = 0;
+}
+
+const cv::Rect &RegionDedup::region() const
+{
+    return lastRegion;
+}
+
+std::uint64_t regionFingerprint(const cv::Mat &image, const cv::Rect &region)
+{
+    cv::Mat small;
+    cv::resize(image(region), small, cv::Size(8, 8), 0, 0, cv::INTER_AREA);
+    if (small.channels() != 1)
+    {
+        cv::cvtColor(small, small, cv::COLOR_BGR2GRAY);
+    }
+
+    int sum = 0;
+    for (int y = 0; y < 8; ++y)
+    {
+        for (int x = 0; x < 8; ++x)
+        {
+            sum += small.at<uchar>(y, x);
+        }
+    }
+    int average = sum / 64;
+
+    std::uint64_t fingerprint = 0;
+    for (int y = 0; y < 8; ++y)
+    {
+        for (int x = 0; x < 8; ++x)
+        {
+            fingerprint = (fingerprint << 1) | (small.at<uchar>(y, x) > average ? 1 : 0);
+        }
+    }
+    return fingerprint;
+}
+
+int fingerprintDistance(std::uint64_t a, std::uint64_t b)
+{
+    return static_cast<int>(std::bitset<64>(a ^ b).count());
+}
+
+cv::Rect resultsBoundingBox(const ZXing::Results &results, const cv::Size &frameSize)
+{
+    int left = INT_MAX, top = INT_MAX, right = INT_MIN, bottom = INT_MIN;
+    for (const auto &result : results)
+    {
+        const auto &position = result.position();
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            left = std::min(left, position[corner].x);
+            top = std::min(top, position[corner].y);
+            right = std::max(right, position[corner].x);
+            bottom = std::max(bottom, position[corner].y);
+        }
+    }
+    if (left > right || top > bottom)
+    {
+        return cv::Rect();
+    }
+
+    left = std::max(0, left);
+    top = std::max(0, top);
+    right = std::min(frameSize.width, right + 1);
+    bottom = std::min(frameSize.height, bottom + 1);
+    if (left >= right || top >= bottom)
+    {
+        return cv::Rect();
+    }
+    return cv::Rect(left, top, right - left, bottom - top);
+}
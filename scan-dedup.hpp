@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <opencv2/opencv.hpp>
+#include "ReadBarcode.h"
+
+using ScanClock = std::chrono::steady_clock;
+
+// IDs handled in the last few seconds. A student holding a card in front
+// of the camera is detected on every frame, only the first detection
+// needs to go through the lookup and the attendance data
+class RecentScanCache
+{
+public:
+    explicit RecentScanCache(std::chrono::milliseconds window);
+
+    // Returns true if the ID was already seen within the window
+    // Either way, the ID is marked as seen at `now`
+    bool seenRecently(const std::string &id, ScanClock::time_point now);
+
+private:
+    std::chrono::milliseconds window;
+    std::unordered_map<std::string, ScanClock::time_point> lastSeen;
+    std::size_t checksSincePrune = 0;
+};
+
+// Remembers where codes were last found in a frame and a fingerprint of
+// that region. If the next frames show the same region unchanged (the same
+// card held still), they do not have to be decoded again
+class RegionDedup
+{
+public:
+    RegionDedup(std::chrono::milliseconds window, int maxSkippedFrames);
+
+    // True if the remembered region looks the same in `frame`, within the
+    // window and the maximum number of consecutive skipped frames
+    bool unchanged(const cv::Mat &frame, ScanClock::time_point now);
+
+    // Remembers the region (in frame coordinates) of the codes found in
+    // `frame`, or forgets the previous region if the region is empty
+    void remember(const cv::Mat &frame, const cv::Rect &region, ScanClock::time_point now);
+
+    const cv::Rect &region() const;
+
+private:
+    std::chrono::milliseconds window;
+    int maxSkippedFrames;
+
+    bool active = false;
+    cv::Rect lastRegion;
+    std::uint64_t lastFingerprint = 0;
+    ScanClock::time_point lastDecoded;
+    int skippedFrames = 0;
+};
+
+// 64-bit average hash of a region: the region is shrunk to 8x8 gray pixels,
+// and each bit tells whether a pixel is brighter than the average
+std::uint64_t regionFingerprint(const cv::Mat &image, const cv::Rect &region);
+
+// Number of differing bits between two fingerprints
+int fingerprintDistance(std::uint64_t a, std::uint64_t b);
+
+// Smallest rectangle holding every detected code, clipped to the frame
+cv::Rect resultsBoundingBox(const ZXing::Results &results, const cv::Size &frameSize);
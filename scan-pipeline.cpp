@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <opencv2/opencv.hpp>
+#include "ReadBarcode.h"
+#include "DecodeHints.h"
+
+#include "scan-pipeline.hpp"
+#include "scan-dedup.hpp"
+
+// How long an idle stage sleeps before polling its input queue again
+static const std::chrono::milliseconds idleWait(1);
+
+ScanPipeline::ScanPipeline(FrameSource &source, const ZXing::DecodeHints &hints, RecordCallback onScan, ScanPipelineOptions options)
+    : source(source),
+      hints(hints),
+      onScan(std::move(onScan)),
+      options(options),
+      frameQueue(options.frameQueueSize),
+      displayQueue(options.displayQueueSize),
+      scanQueue(options.scanQueueSize)
+{
+    if (this->options.decoderThreads <= 0)
+    {
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        this->options.decoderThreads = std::max(1, cores - 1);
+    }
+
+    Metrics *metrics = this->options.metrics;
+    capturedCount = metrics ? &metrics->counter("frames.captured") : &ownCounters[0];
+    droppedCount = metrics ? &metrics->counter("frames.dropped") : &ownCounters[1];
+    skippedCount = metrics ? &metrics->counter("frames.skipped") : &ownCounters[2];
+    duplicateCount = metrics ? &metrics->counter("scans.duplicate") : &ownCounters[3];
+    decodedCount = metrics ? &metrics->counter("detections") : &ownCounters[4];
+    recordedCount = metrics ? &metrics->counter("scans.processed") : &ownCounters[5];
+
+    if (metrics)
+    {
+        // "scan" is from the capture of a frame to the end of the record callback
+        captureLatency = &metrics->histogram("capture");
+        decodeLatency = &metrics->histogram("decode");
+        recordLatency = &metrics->histogram("record");
+        scanLatency = &metrics->histogram("scan");
+    }
+}
+
+ScanPipeline::~ScanPipeline()
+{
+    stop();
+}
+
+void ScanPipeline::start()
+{
+    if (capturing.exchange(true))
+    {
+        return; // Already running
+    }
+
+    activeDecoders = options.decoderThreads;
+
+    recorderThread = std::thread(&ScanPipeline::recordLoop, this);
+    for (int i = 0; i < options.decoderThreads; ++i)
+    {
+        decoderThreads.emplace_back(&ScanPipeline::decodeLoop, this);
+    }
+    captureThread = std::thread(&ScanPipeline::captureLoop, this);
+}
+
+void ScanPipeline::stop()
+{
+    capturing = false;
+
+    // Joins the stages in the order the data flows through them,
+    // so that every captured frame is decoded and every scan is recorded
+    if (captureThread.joinable())
+    {
+        captureThread.join();
+    }
+    for (auto &decoderThread : decoderThreads)
+    {
+        if (decoderThread.joinable())
+        {
+            decoderThread.join();
+        }
+    }
+    decoderThreads.clear();
+    if (recorderThread.joinable())
+    {
+        recorderThread.join();
+    }
+}
+
+bool ScanPipeline::finished() const
+{
+    return sourceFinished && activeDecoders == 0;
+}
+
+bool ScanPipeline::latestFrame(cv::Mat &frame)
+{
+    // Skips to the newest frame, older ones are already stale
+    bool found = false;
+    CapturedFrame displayed;
+    while (displayQueue.tryPop(displayed))
+    {
+        found = true;
+    }
+    if (found)
+    {
+        frame = displayed.image;
+    }
+    return found;
+}
+
+std::uint64_t ScanPipeline::framesCaptured() const
+{
+    return capturedCount->value();
+}
+
+std::uint64_t ScanPipeline::framesDropped() const
+{
+    return droppedCount->value();
+}
+
+std::uint64_t ScanPipeline::framesSkipped() const
+{
+    return skippedCount->value();
+}
+
+std::uint64_t ScanPipeline::duplicateScans() const
+{
+    return duplicateCount->value();
+}
+
+std::uint64_t ScanPipeline::scansDecoded() const
+{
+    return decodedCount->value();
+}
+
+std::uint64_t ScanPipeline::scansRecorded() const
+{
+    return recordedCount->value();
+}
+
+void ScanPipeline::captureLoop()
+{
+    bool dropFrames = source.isRealTime();
+    std::uint64_t nextSequence = 0;
+
+    while (capturing)
+    {
+        // A new Mat is used for every frame since the previous
+        // one is still owned by a decoder or the display
+        CapturedFrame frame;
+        MetricsClock::time_point readStarted;
+        if (captureLatency)
+        {
+            readStarted = MetricsClock::now();
+        }
+        if (!source.next(frame.image))
+        {
+            if (source.finished())
+            {
+                // The decoders finish the queued frames and exit
+                sourceFinished = true;
+                capturing = false;
+                break;
+            }
+            std::this_thread::sleep_for(idleWait);
+            continue;
+        }
+        frame.sequence = nextSequence++;
+        capturedCount->add();
+        if (captureLatency)
+        {
+            frame.capturedAt = MetricsClock::now();
+            captureLatency->record(frame.capturedAt - readStarted);
+        }
+
+        // Backpressure: when the decoders fall behind, the oldest waiting
+        // frame is dropped instead of letting the latency build up
+        while (!frameQueue.tryPush(std::move(frame)))
+        {
+            if (!dropFrames)
+            {
+                std::this_thread::sleep_for(idleWait);
+                if (!capturing)
+                {
+                    break;
+                }
+                continue;
+            }
+            CapturedFrame staleFrame;
+            if (frameQueue.tryPop(staleFrame))
+            {
+                droppedCount->add();
+            }
+        }
+    }
+}
+
+void ScanPipeline::decodeLoop()
+{
+    // Each decoder tracks the region of its own last detection
+    RegionDedup regionDedup(options.regionDedupWindow, options.maxSkippedFrames);
+    RoiTracker roiTracker(options.roi);
+
+    while (true)
+    {
+        CapturedFrame frame;
+        if (!frameQueue.tryPop(frame))
+        {
+            if (capturing)
+            {
+                std::this_thread::sleep_for(idleWait);
+                continue;
+            }
+
+            // The capture thread may have pushed its last frame between the
+            // failed pop and `capturing` turning false, so the queue is
+            // checked once more before exiting
+            if (!frameQueue.tryPop(frame))
+            {
+                break; // No more frames will come
+            }
+        }
+
+        // The same card held still, its ID was already sent to the recorder
+        auto now = ScanClock::now();
+        if (regionDedup.unchanged(frame.image, now))
+        {
+            skippedCount->add();
+            if (options.displayFrames)
+            {
+                if (options.drawResults)
+                {
+                    cv::rectangle(frame.image, regionDedup.region(), cv::Scalar(0, 255, 0), 2);
+                }
+                publishFrame(frame);
+            }
+            continue;
+        }
+
+        // Extracts barcode info from the window around the last detection,
+        // or from the whole frame (see roi-tracker.hpp)
+        TrackedResults tracked = roiTracker.decode(frame.image, hints);
+        if (decodeLatency)
+        {
+            decodeLatency->record(MetricsClock::now() - now);
+        }
+        regionDedup.remember(frame.image, tracked.detectedRegion, now);
+
+        if (options.displayFrames && options.drawResults)
+        {
+            // Draws the results to the webcam monitor
+            RoiTracker::draw(frame.image, tracked);
+        }
+
+        for (auto &r : tracked.results)
+        {
+            // Scans are attendance records, so they are never dropped.
+            // The recorder is much faster than the decoders, so waiting
+            // here only happens in bursts
+            ScanEvent event{frame.sequence, r.text(), frame.capturedAt};
+            decodedCount->add();
+            while (!scanQueue.tryPush(std::move(event)))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        if (options.displayFrames)
+        {
+            publishFrame(frame);
+        }
+    }
+
+    activeDecoders--;
+}
+
+void ScanPipeline::publishFrame(CapturedFrame &frame)
+{
+    while (!displayQueue.tryPush(std::move(frame)))
+    {
+        CapturedFrame staleFrame;
+        displayQueue.tryPop(staleFrame);
+    }
+}
+
+void ScanPipeline::recordLoop()
+{
+    RecentScanCache recentScans(options.scanDedupWindow);
+
+    // Skips the IDs that were just handled, before any lookup
+    auto record = [this, &recentScans](const ScanEvent &event)
+    {
+        if (options.scanDedupWindow.count() > 0 && recentScans.seenRecently(event.decodedID, ScanClock::now()))
+        {
+            duplicateCount->add();
+            return;
+        }
+        recordedCount->add();
+
+        if (recordLatency)
+        {
+            auto recordStarted = MetricsClock::now();
+            onScan(event.decodedID);
+            auto recordEnded = MetricsClock::now();
+            recordLatency->record(recordEnded - recordStarted);
+            scanLatency->record(recordEnded - event.capturedAt);
+            return;
+        }
+        onScan(event.decodedID);
+    };
+
+    while (true)
+    {
+        ScanEvent event;
+        if (scanQueue.tryPop(event))
+        {
+            record(event);
+            continue;
+        }
+
+        if (activeDecoders == 0)
+        {
+            // The decoders are done, records what was pushed before they exited
+            while (scanQueue.tryPop(event))
+            {
+                record(event);
+            }
+            break;
+        }
+        std::this_thread::sleep_for(idleWait);
+    }
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+#include "DecodeHints.h"
+
+#include "frame-source.hpp"
+#include "metrics.hpp"
+#include "ring-buffer.hpp"
+#include "roi-tracker.hpp"
+
+// A frame captured from the frame source, tagged with its capture order
+struct CapturedFrame
+{
+    std::uint64_t sequence = 0;
+    cv::Mat image;
+
+    // Only set when the metrics are enabled
+    MetricsClock::time_point capturedAt;
+};
+
+// A decoded barcode/QR code text, passed from the decoders to the recorder
+struct ScanEvent
+{
+    std::uint64_t sequence = 0;
+    std::string decodedID;
+    MetricsClock::time_point capturedAt;
+};
+
+struct ScanPipelineOptions
+{
+    // Number of decoder threads, 0 means one less than the number of cores
+    int decoderThreads = 0;
+
+    // Frames waiting to be decoded. When full, the oldest frame is
+    // dropped so that the decoders always work on recent frames. A replay
+    // at full speed waits for space instead, so that every frame is decoded
+    std::size_t frameQueueSize = 4;
+
+    // Annotated frames waiting to be displayed, also drops the oldest
+    std::size_t displayQueueSize = 2;
+
+    // Decoded IDs waiting to be recorded, these are never dropped
+    std::size_t scanQueueSize = 256;
+
+    // Sends the decoded frames to the display queue (see latestFrame).
+    // Turned off when nothing is shown, e.g. in headless mode
+    bool displayFrames = true;
+
+    // Draws the detected codes on the frames sent to the display queue
+    bool drawResults = true;
+
+    // An ID detected again within this window is not passed to the record
+    // callback (0 disables)
+    std::chrono::milliseconds scanDedupWindow{3000};
+
+    // A frame whose code region looks unchanged since the last decode is
+    // not decoded again, for at most this long and this many frames in a
+    // row (0 disables)
+    std::chrono::milliseconds regionDedupWindow{1000};
+    int maxSkippedFrames = 15;
+
+    // Decodes a window around the last detection instead of the whole frame
+    RoiOptions roi;
+
+    // When set, the frame counters are kept in the metrics and the latencies
+    // of each stage are recorded (see metrics.hpp)
+    Metrics *metrics = nullptr;
+};
+
+// Multi-stage scanning pipeline
+//
+//      [capture thread] -> frames -> [decoder threads] -> scans -> [recorder thread]
+//                                            |
+//                                            +-> display -> [UI thread (caller)]
+//
+// The stages are connected by bounded lock-free ring buffers. The recorder
+// callback is only ever called from the single recorder thread, so it can
+// update the attendance data without locking
+class ScanPipeline
+{
+public:
+    using RecordCallback = std::function<void(const std::string &decodedID)>;
+
+    ScanPipeline(FrameSource &source, const ZXing::DecodeHints &hints, RecordCallback onScan, ScanPipelineOptions options = {});
+    ~ScanPipeline();
+
+    ScanPipeline(const ScanPipeline &) = delete;
+    ScanPipeline &operator=(const ScanPipeline &) = delete;
+
+    void start();
+
+    // Stops capturing, lets the decoders finish and records every pending scan
+    void stop();
+
+    // True once a recording was read to the end and every frame was decoded
+    bool finished() const;
+
+    // Gets the most recent annotated frame, to be called from the UI thread.
+    // Returns false if no new frame was produced since the last call
+    bool latestFrame(cv::Mat &frame);
+
+    std::uint64_t framesCaptured() const;
+    std::uint64_t framesDropped() const;
+    std::uint64_t framesSkipped() const;
+    std::uint64_t duplicateScans() const;
+
+    // Codes decoded, and those passed to the record callback
+    std::uint64_t scansDecoded() const;
+    std::uint64_t scansRecorded() const;
+
+private:
+    void captureLoop();
+    void decodeLoop();
+    void recordLoop();
+
+    // Pushes a decoded frame to the display queue, replacing the oldest
+    void publishFrame(CapturedFrame &frame);
+
+    FrameSource &source;
+    ZXing::DecodeHints hints;
+    RecordCallback onScan;
+    ScanPipelineOptions options;
+
+    RingBuffer<CapturedFrame> frameQueue;
+    RingBuffer<CapturedFrame> displayQueue;
+    RingBuffer<ScanEvent> scanQueue;
+
+    std::thread captureThread;
+    std::vector<std::thread> decoderThreads;
+    std::thread recorderThread;
+
+    std::atomic<bool> capturing{false};
+    std::atomic<bool> sourceFinished{false};
+    std::atomic<int> activeDecoders{0};
+
+    // The counters point to the metrics' counters if the metrics are
+    // enabled, otherwise to the pipeline's own
+    Counter ownCounters[6];
+    Counter *capturedCount;
+    Counter *droppedCount;
+    Counter *skippedCount;
+    Counter *duplicateCount;
+    Counter *decodedCount;
+    Counter *recordedCount;
+
+    // Latencies of the stages, null if the metrics are disabled
+    Histogram *captureLatency = nullptr;
+    Histogram *decodeLatency = nullptr;
+    Histogram *recordLatency = nullptr;
+    Histogram *scanLatency = nullptr;
+};
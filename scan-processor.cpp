@@ -0,0 +1,36 @@
+#include <string>
+
+#include "utils.hpp"
+#include "scan-processor.hpp"
+
+ScanProcessor::ScanProcessor(const Roster &roster, AttendanceStore &store, ClockService &clock, std::string mode)
+    : roster(roster), store(store), clock(clock), mode(std::move(mode))
+{
+}
+
+ScanResult ScanProcessor::process(const std::string &decodedID)
+{
+    ScanResult result;
+
+    const StudentRecord *student = roster.find(decodedID);
+
+    // Detects if the student with the scanned ID is registered or not
+    if (student == nullptr)
+    {
+        result.status = ScanStatus::Unregistered;
+        result.event.id = decodedID;
+        return result;
+    }
+
+    // "%a %m-%d-%Y" Date format (ex. "Tue 11-29-2023")
+    // "%H:%M" Time format (ex. "15:45")
+    // Both fit in the small string buffer, so no allocation
+    ClockStamp stamp = clock.now();
+    result.event = AttendanceEvent{stamp.date, std::string(roster.courseAndSection(*student)),
+                                   mode, decodedID, stamp.time};
+    result.name = roster.name(*student);
+
+    // Stores the info (time) if the student is not recorded yet
+    result.status = store.record(result.event) ? ScanStatus::Recorded : ScanStatus::AlreadyRecorded;
+    return result;
+}
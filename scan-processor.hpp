@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "attendance-store.hpp"
+#include "roster.hpp"
+#include "utils.hpp"
+
+enum class ScanStatus
+{
+    Recorded,
+    AlreadyRecorded,
+    Unregistered
+};
+
+struct ScanResult
+{
+    ScanStatus status;
+
+    // Filled for registered students (the date and time of the scan,
+    // their section and the mode), even if they were already recorded
+    AttendanceEvent event;
+
+    // Name of the student, empty if unregistered. Points into the roster
+    std::string_view name;
+};
+
+// Turns a decoded ID into an attendance record: finds the student in the
+// roster, timestamps the scan and stores it for the selected mode
+class ScanProcessor
+{
+public:
+    ScanProcessor(const Roster &roster, AttendanceStore &store, ClockService &clock, std::string mode);
+
+    // Not thread-safe, see AttendanceStore::record
+    ScanResult process(const std::string &decodedID);
+
+private:
+    const Roster &roster;
+    AttendanceStore &store;
+    ClockService &clock;
+    std::string mode;
+};
@@ -0,0 +1,103 @@
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "BarcodeFormat.h"
+#include "DecodeHints.h"
+#include <nlohmann/json.hpp>
+
+#include "scanner-config.hpp"
+
+using json = nlohmann::json;
+
+ScannerConfig loadScannerConfig(const std::string &filename)
+{
+    ScannerConfig config;
+
+    std::ifstream input(filename);
+    if (!input.is_open())
+    {
+        return config;
+    }
+
+    try
+    {
+        json data = json::parse(input);
+
+        config.formats = data.value("formats", config.formats);
+        config.tryHarder = data.value("tryHarder", config.tryHarder);
+        config.tryRotate = data.value("tryRotate", config.tryRotate);
+        config.tryDownscale = data.value("tryDownscale", config.tryDownscale);
+        config.binarizer = data.value("binarizer", config.binarizer);
+        config.downscaleThreshold = data.value("downscaleThreshold", config.downscaleThreshold);
+        config.downscaleFactor = data.value("downscaleFactor", config.downscaleFactor);
+        config.maxSymbols = data.value("maxSymbols", config.maxSymbols);
+
+        ScanPipelineOptions &pipeline = config.pipeline;
+        pipeline.decoderThreads = data.value("decoderThreads", pipeline.decoderThreads);
+        pipeline.scanDedupWindow = std::chrono::milliseconds(data.value("scanDedupMs", static_cast<long long>(pipeline.scanDedupWindow.count())));
+        pipeline.regionDedupWindow = std::chrono::milliseconds(data.value("regionDedupMs", static_cast<long long>(pipeline.regionDedupWindow.count())));
+        pipeline.maxSkippedFrames = data.value("maxSkippedFrames", pipeline.maxSkippedFrames);
+
+        if (data.contains("roi"))
+        {
+            const json &roi = data["roi"];
+            pipeline.roi.enabled = roi.value("enabled", pipeline.roi.enabled);
+            pipeline.roi.margin = roi.value("margin", pipeline.roi.margin);
+            pipeline.roi.fullScanInterval = roi.value("fullScanInterval", pipeline.roi.fullScanInterval);
+            pipeline.roi.prepassScale = roi.value("prepassScale", pipeline.roi.prepassScale);
+        }
+    }
+    catch (const json::exception &e)
+    {
+        throw std::runtime_error("Invalid scanner configuration " + filename + ": " + e.what());
+    }
+
+    return config;
+}
+
+ZXing::DecodeHints buildDecodeHints(const ScannerConfig &config)
+{
+    ZXing::Binarizer binarizer;
+    if (config.binarizer == "LocalAverage")
+    {
+        binarizer = ZXing::Binarizer::LocalAverage;
+    }
+    else if (config.binarizer == "GlobalHistogram")
+    {
+        binarizer = ZXing::Binarizer::GlobalHistogram;
+    }
+    else if (config.binarizer == "FixedThreshold")
+    {
+        binarizer = ZXing::Binarizer::FixedThreshold;
+    }
+    else if (config.binarizer == "BoolCast")
+    {
+        binarizer = ZXing::Binarizer::BoolCast;
+    }
+    else
+    {
+        throw std::runtime_error("Unknown binarizer: " + config.binarizer);
+    }
+
+    ZXing::BarcodeFormats formats;
+    try
+    {
+        formats = ZXing::BarcodeFormatsFromString(config.formats);
+    }
+    catch (const std::exception &e)
+    {
+        throw std::runtime_error("Unknown barcode format in \"" + config.formats + "\": " + e.what());
+    }
+
+    return ZXing::DecodeHints()
+        .setFormats(formats)
+        .setTryHarder(config.tryHarder)
+        .setTryRotate(config.tryRotate)
+        .setTryDownscale(config.tryDownscale)
+        .setBinarizer(binarizer)
+        .setDownscaleThreshold(static_cast<unsigned short>(config.downscaleThreshold))
+        .setDownscaleFactor(static_cast<unsigned char>(config.downscaleFactor))
+        .setMaxNumberOfSymbols(static_cast<unsigned char>(config.maxSymbols));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+
+#include "DecodeHints.h"
+
+#include "scan-pipeline.hpp"
+
+// Decoder and pipeline settings of a scanning station, read once at startup
+// from a JSON profile (scanner-config.json). Every key is optional:
+//      {
+//          "formats": "QRCode|Code128",    ZXing format names, "" for every format
+//          "tryHarder": true,
+//          "tryRotate": true,
+//          "tryDownscale": true,
+//          "binarizer": "LocalAverage",    LocalAverage, GlobalHistogram, FixedThreshold or BoolCast
+//          "downscaleThreshold": 500,      frames larger than this (pixels) are also decoded downscaled
+//          "downscaleFactor": 3,
+//          "maxSymbols": 255,              stops after this many codes per frame
+//          "decoderThreads": 0,
+//          "scanDedupMs": 3000,
+//          "regionDedupMs": 1000,
+//          "maxSkippedFrames": 15,
+//          "roi": { "enabled": true, "margin": 0.5, "fullScanInterval": 10, "prepassScale": 0 }
+//      }
+struct ScannerConfig
+{
+    // IDs are QR codes, old cards are Code128
+    std::string formats = "QRCode|Code128";
+    bool tryHarder = true;
+    bool tryRotate = true;
+    bool tryDownscale = true;
+    std::string binarizer = "LocalAverage";
+    int downscaleThreshold = 500;
+    int downscaleFactor = 3;
+    int maxSymbols = 255;
+
+    ScanPipelineOptions pipeline;
+};
+
+// Returns the defaults if the file does not exist
+// Throws std::runtime_error if the file is invalid
+ScannerConfig loadScannerConfig(const std::string &filename);
+
+// Builds the decode hints once, to be shared by every decoded frame
+// Throws std::runtime_error if a format or the binarizer is unknown
+ZXing::DecodeHints buildDecodeHints(const ScannerConfig &config);
@@ -0,0 +1,82 @@
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <OpenXLSX.hpp>
+
+#include "sheet-index.hpp"
+
+using namespace OpenXLSX;
+
+SheetIndex SheetIndex::build(const XLWorksheet &wks)
+{
+    SheetIndex index;
+
+    // Gets the dates already written to the sheet (in the third row), and
+    // Finds the first empty cell in the third row, starting from "C3"
+    // A date spans 4 columns, only the first one is kept
+    XLCell currentCell = wks.cell(XLCellReference("C3"));
+    while (currentCell.value().type() != XLValueType::Empty)
+    {
+        std::string date = currentCell.value().get<std::string>();
+        index.dateColumns.emplace(date, index.lastEmptyColumn);
+        currentCell = wks.cell(XLCellReference(3, ++index.lastEmptyColumn));
+    }
+
+    // Gets the IDs already written to the sheet, and
+    // Finds the first empty cell in the first column, starting from "A5"
+    currentCell = wks.cell(XLCellReference("A5"));
+    while (currentCell.value().type() != XLValueType::Empty)
+    {
+        std::string id = currentCell.value().get<std::string>();
+        index.studentRows.emplace(id, index.lastEmptyRow);
+        currentCell = wks.cell(XLCellReference(++index.lastEmptyRow, 1));
+    }
+
+    return index;
+}
+
+bool SheetIndex::hasDate(const std::string &date) const
+{
+    return dateColumns.find(date) != dateColumns.end();
+}
+
+bool SheetIndex::hasStudent(const std::string &id) const
+{
+    return studentRows.find(id) != studentRows.end();
+}
+
+int SheetIndex::dateColumn(const std::string &date) const
+{
+    auto iterator = dateColumns.find(date);
+    return iterator == dateColumns.end() ? -1 : iterator->second;
+}
+
+int SheetIndex::studentRow(const std::string &id) const
+{
+    auto iterator = studentRows.find(id);
+    return iterator == studentRows.end() ? -1 : iterator->second;
+}
+
+int SheetIndex::addDate(XLWorksheet &wks, const std::string &date, const std::vector<std::string> &modes)
+{
+    int firstColumn = lastEmptyColumn;
+    for (const auto &mode : modes)
+    {
+        wks.cell(XLCellReference(3, lastEmptyColumn)).value() = date;
+        wks.cell(XLCellReference(4, lastEmptyColumn)).value() = mode;
+        lastEmptyColumn++;
+    }
+    dateColumns.emplace(date, firstColumn);
+    return firstColumn;
+}
+
+int SheetIndex::addStudent(XLWorksheet &wks, const std::string &id, const std::string &name)
+{
+    int row = lastEmptyRow;
+    wks.cell(XLCellReference(row, 1)).value() = id;
+    wks.cell(XLCellReference(row, 2)).value() = name;
+    lastEmptyRow++;
+    studentRows.emplace(id, row);
+    return row;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <OpenXLSX.hpp>
+
+// Positions of the headers of one attendance worksheet
+//
+//      Row 3: dates, each date spans 4 columns (one per mode), starting at C3
+//      Row 4: modes
+//      Column A: IDs, starting at A5
+//      Column B: names
+//
+// The headers are read once when the index is built, then every lookup
+// is a hash map access instead of a walk over the cells
+class SheetIndex
+{
+public:
+    static SheetIndex build(const OpenXLSX::XLWorksheet &wks);
+
+    bool hasDate(const std::string &date) const;
+    bool hasStudent(const std::string &id) const;
+
+    // Returns the first column of the date (the column of the first mode), or -1 if not written
+    int dateColumn(const std::string &date) const;
+
+    // Returns the row of the student, or -1 if not written
+    int studentRow(const std::string &id) const;
+
+    // Writes the date and the modes to the first empty columns of rows 3 and 4
+    // Returns the first column of the date
+    int addDate(OpenXLSX::XLWorksheet &wks, const std::string &date, const std::vector<std::string> &modes);
+
+    // Writes the ID and the name to the first empty row
+    // Returns the row of the student
+    int addStudent(OpenXLSX::XLWorksheet &wks, const std::string &id, const std::string &name);
+
+private:
+    std::unordered_map<std::string, int> dateColumns;
+    std::unordered_map<std::string, int> studentRows;
+
+    // First empty column of row 3 and first empty row of column A
+    int lastEmptyColumn = 3;
+    int lastEmptyRow = 5;
+};
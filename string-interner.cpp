@@ -0,0 +1,90 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "string-interner.hpp"
+#include "utils.hpp"
+
+void StringInterner::reserve(std::size_t symbols, std::size_t bytes)
+{
+    arena.reserve(bytes);
+    spans.reserve(symbols);
+
+    // Keeps the table at most half full
+    std::size_t size = 16;
+    while (size < symbols * 2)
+    {
+        size <<= 1;
+    }
+    if (size > slots.size())
+    {
+        slots.assign(size, noSymbol);
+        for (Symbol symbol = 0; symbol < spans.size(); ++symbol)
+        {
+            slots[slotOf(view(symbol), spans[symbol].hash)] = symbol;
+        }
+    }
+}
+
+StringInterner::Symbol StringInterner::intern(std::string_view text)
+{
+    if ((spans.size() + 1) * 2 > slots.size())
+    {
+        grow();
+    }
+
+    std::uint32_t hash = static_cast<std::uint32_t>(fnv1aHash(text));
+    std::size_t slot = slotOf(text, hash);
+    if (slots[slot] != noSymbol)
+    {
+        return slots[slot];
+    }
+
+    Symbol symbol = static_cast<Symbol>(spans.size());
+    spans.push_back({static_cast<std::uint32_t>(arena.size()), static_cast<std::uint32_t>(text.size()), hash});
+    arena.append(text.data(), text.size());
+    slots[slot] = symbol;
+    return symbol;
+}
+
+StringInterner::Symbol StringInterner::find(std::string_view text) const
+{
+    if (slots.empty())
+    {
+        return noSymbol;
+    }
+    return slots[slotOf(text, static_cast<std::uint32_t>(fnv1aHash(text)))];
+}
+
+std::string_view StringInterner::view(Symbol symbol) const
+{
+    const Span &span = spans[symbol];
+    return std::string_view(arena.data() + span.offset, span.length);
+}
+
+std::size_t StringInterner::size() const
+{
+    return spans.size();
+}
+
+// Finds the slot holding `text`, or the empty slot where it would be inserted
+std::size_t StringInterner::slotOf(std::string_view text, std::uint32_t hash) const
+{
+    std::size_t mask = slots.size() - 1;
+    std::size_t slot = hash & mask;
+    while (slots[slot] != noSymbol)
+    {
+        const Span &span = spans[slots[slot]];
+        if (span.hash == hash && view(slots[slot]) == text)
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void StringInterner::grow()
+{
+    reserve(slots.empty() ? 8 : slots.size(), arena.size());
+}
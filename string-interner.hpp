@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Stores each distinct string once, in one contiguous buffer, and refers to
+// it by a small integer (symbol). Interning the same text twice gives the
+// same symbol, so interned strings can be compared by their symbols
+class StringInterner
+{
+public:
+    using Symbol = std::uint32_t;
+
+    static constexpr Symbol noSymbol = UINT32_MAX;
+
+    void reserve(std::size_t symbols, std::size_t bytes);
+
+    // Returns the symbol of `text`, adding it if it is not interned yet
+    Symbol intern(std::string_view text);
+
+    // Returns the symbol of `text`, or `noSymbol` if it was never interned
+    Symbol find(std::string_view text) const;
+
+    // The returned view stays valid until the next call to `intern`
+    std::string_view view(Symbol symbol) const;
+
+    std::size_t size() const;
+
+private:
+    struct Span
+    {
+        std::uint32_t offset;
+        std::uint32_t length;
+        std::uint32_t hash;
+    };
+
+    std::size_t slotOf(std::string_view text, std::uint32_t hash) const;
+    void grow();
+
+    std::string arena;
+    std::vector<Span> spans;
+
+    // Open-addressing (linear probing) table of symbols, the size is a power of two
+    std::vector<Symbol> slots;
+};
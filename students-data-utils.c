@@ -118,23 +118,6 @@ const char *analyzeString(const char *str)
     }
 }
 
-json_t *findObjectInArray(json_t *array, const char *key, const char *value)
-{
-    size_t index;
-    json_t *object;
-
-    json_array_foreach(array, index, object)
-    {
-        const char *object_value = json_string_value(json_object_get(object, key));
-        if (object_value && strcmp(object_value, value) == 0)
-        {
-            return object;
-        }
-    }
-
-    return NULL;
-}
-
 void printArrayOfObjects(json_t *array, bool appendRowNumber)
 {
     size_t index;
@@ -276,46 +259,48 @@ void *createHyphenString(int numHyphens)
     return hyphenString;
 }
 
-int readFileStatic(const char *filename, char *buffer, size_t buffer_size)
+// Parses a JSON file of any size directly from the file stream
+// The file is never copied to a fixed size buffer, jansson reads it
+// through the stream's own buffer, so the only memory used
+// is the parsed document itself
+json_t *loadJsonFile(const char *filename, json_error_t *error, long *bytesRead)
 {
-    // FILE: file stream structure
     FILE *file = fopen(filename, "rb");
-
     if (file == NULL)
     {
-        perror("Error opening file");
-        return 0; // Return 0 to indicate failure
+        // Filled like a parse error, since the callers print `error`
+        if (error != NULL)
+        {
+            error->line = -1;
+            error->column = -1;
+            error->position = 0;
+            snprintf(error->source, JSON_ERROR_SOURCE_LENGTH, "%s", filename);
+            snprintf(error->text, JSON_ERROR_TEXT_LENGTH, "unable to open %s: %s", filename, strerror(errno));
+        }
+        return NULL;
     }
 
-    // Read at most (buffer_size - 1) bytes to leave room for the null terminator
-    // arguments: buffer, step size, # of elements to read, stream
-    size_t bytes_read = fread(buffer, 1, buffer_size - 1, file);
+    // A bigger stream buffer means fewer reads for large files
+    setvbuf(file, NULL, _IOFBF, 1 << 16);
 
-    // Null-terminate the buffer
-    buffer[bytes_read] = '\0';
+    json_t *json = json_loadf(file, 0, error);
+
+    if (bytesRead != NULL)
+    {
+        *bytesRead = ftell(file);
+    }
 
     fclose(file);
 
-    return 1; // Return 1 to indicate success
+    return json;
 }
 
-void removeObjectFromArray(json_t *array, const char *key, const char *value)
+// Returns the number of seconds elapsed since `start` (from timespec_get)
+double secondsSince(const struct timespec *start)
 {
-    size_t index;
-    json_t *object;
-    char *object_key;
-    json_t *object_value;
-
-    json_array_foreach(array, index, object)
-    {
-        object_value = json_object_get(object, key);
-        const char *object_value_str = json_string_value(object_value);
-        if (object_value_str && strcmp(object_value_str, value) == 0)
-        {
-            json_array_remove(array, index);
-            break;
-        }
-    }
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
 }
 
 void modifyObject(json_t *object, const char *key, json_t *new_value)
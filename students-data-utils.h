@@ -1,5 +1,7 @@
 #include <jansson.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
 
 char **getFilenames(const char *dir_path);
 
@@ -11,8 +13,6 @@ void readLine(char *buffer, size_t bufferSize, FILE *stream);
 
 const char *analyzeString(const char *str);
 
-json_t *findObjectInArray(json_t *array, const char *key, const char *value);
-
 void printArrayOfObjects(json_t *array, bool appendRowNumber);
 
 void ljust(char *str, int width, char padChar);
@@ -27,9 +27,9 @@ void printRawString(const char *str);
 
 void removeNewlines(char *str);
 
-int readFileStatic(const char *filename, char *buffer, size_t buffer_size);
+json_t *loadJsonFile(const char *filename, json_error_t *error, long *bytesRead);
 
-void removeObjectFromArray(json_t *array, const char *key, const char *value);
+double secondsSince(const struct timespec *start);
 
 void modifyObject(json_t *object, const char *key, json_t *new_value);
 
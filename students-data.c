@@ -2,12 +2,15 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #include <jansson.h>
 
 #include "students-data-utils.h"
+#include "students-index.h"
+#include "students-import.h"
 
-int main()
+int main(int argc, char *argv[])
 {
     // [1] Checks if students-data.json already exists in the current directory
 
@@ -30,11 +33,47 @@ int main()
     }
     freeArrayOfStrings(filenames); // Free resources
 
+    // [1B] Non-interactive bulk import
+    // Usage: students-data --import <file.csv | file.tsv>
+    if (argc == 3 && strcmp(argv[1], "--import") == 0)
+    {
+        json_error_t error;
+        json_t *roster = jsonFileExists ? loadJsonFile("students-data.json", &error, NULL) : json_object();
+        if (roster == NULL)
+        {
+            fprintf(stderr, "error: on line %d: %s\n", error.line, error.text);
+            return 1;
+        }
+
+        StudentIndex index;
+        ImportStats stats;
+        if (!studentIndexBuild(&index, roster) || !importRoster(argv[2], roster, &index, &stats))
+        {
+            return 1;
+        }
+
+        // Writes the merged roster in one pass
+        if (json_dump_file(roster, "students-data.json", JSON_INDENT(2)) != 0)
+        {
+            fprintf(stderr, "error: could not write to file\n");
+            return 1;
+        }
+
+        printf("%zu rows: %zu imported, %zu duplicate IDs, %zu invalid\n", stats.rows, stats.imported, stats.duplicates, stats.invalid);
+        printf("%.3f s (%.0f rows/second)\n", stats.seconds, stats.seconds > 0 ? stats.rows / stats.seconds : 0.0);
+
+        studentIndexFree(&index);
+        json_decref(roster);
+        return 0;
+    }
+
     // [2] Retrieves the necessary data
 
     json_t *jsonObject = json_object(); // Object to where the data in the file is placed
     int sectionsNum = 0;                // Track the number of sections
     char **sections = NULL;             // Array of strings (section names)
+    long loadedBytes = 0;               // Size of the loaded students-data.json
+    double loadMilliseconds = 0;        // Time it took to load it
 
     if (!jsonFileExists)
     {
@@ -123,20 +162,13 @@ int main()
 
         // [2B.1] Get data from students-data.json file
 
-        // Opens students-data.json file and reads its contents
-        // The `readFileStatic` reads the text from 'students-data.json' file,
-        // and then puts it on the `jsonString` variable
-        char jsonString[10240]; // 10240 bytes or 10 megabyte
-        if (!readFileStatic("students-data.json", jsonString, sizeof(jsonString)))
-        {
-            fprintf(stderr, "Error reading input\n");
-            pause();
-            return 1;
-        }
+        // Opens students-data.json file and parses it while reading, so
+        // rosters of any size can be loaded
+        struct timespec loadStart;
+        timespec_get(&loadStart, TIME_UTC);
 
-        // Convert the string to a JSON object
         json_error_t error; // Variable where the error info will be stored
-        jsonObject = json_loads(jsonString, 0, &error);
+        jsonObject = loadJsonFile("students-data.json", &error, &loadedBytes);
         if (!jsonObject) // If it fails
         {
             fprintf(stderr, "error: on line %d: %s\n", error.line, error.text);
@@ -144,6 +176,8 @@ int main()
             return 1;
         }
 
+        loadMilliseconds = secondsSince(&loadStart) * 1000;
+
         // Gets all sections registered
         const char *sectionName; // The property name
         json_t *array;           // JSON values should be of type `json_t`
@@ -175,6 +209,15 @@ int main()
         }
     }
 
+    // Index of every student ID, for constant time lookups and duplicate checks
+    StudentIndex studentIndex;
+    if (!studentIndexBuild(&studentIndex, jsonObject))
+    {
+        fprintf(stderr, "Memory allocation error\n");
+        pause();
+        return 1;
+    }
+
     // [3] Goes to edit mode
 
     // Variable that tracks if the inputted value is valid or not
@@ -206,6 +249,13 @@ int main()
         }
         printf("\n----------------------------------------------\n");
 
+        // Load timing, shown on the first screen only
+        if (loadedBytes > 0)
+        {
+            printf("Loaded students-data.json (%ld bytes) in %.1f ms\n", loadedBytes, loadMilliseconds);
+            loadedBytes = 0;
+        }
+
         // Instructions
         printf("\nSelect section to edit\n\nOR\n\n[a] Add section\n[r] Remove section\n[q] (Quit) Save changes and exit program\n\n");
 
@@ -313,17 +363,31 @@ int main()
                                 json_decref(newNameVal);
                             }
 
-                            // Inputs new ID
-                            char newID[10];
-                            printf("Enter the new ID [%s] > ", json_string_value(json_object_get(studentObject, "id")));
+                            // Inputs new ID, until it is not used by another student
+                            while (true)
+                            {
+                                char newID[10];
+                                printf("Enter the new ID [%s] > ", json_string_value(json_object_get(studentObject, "id")));
 
-                            readLine(newID, sizeof(newID), stdin);
+                                readLine(newID, sizeof(newID), stdin);
 
-                            if (strlen(newID) != 0)
-                            {
-                                json_t *newIDVal = json_string(newID);
-                                modifyObject(studentObject, "id", newIDVal);
-                                json_decref(newIDVal);
+                                if (strlen(newID) == 0)
+                                {
+                                    break;
+                                }
+                                StudentUpdateResult result = changeStudentID(&studentIndex, studentObject, newID);
+                                if (result == STUDENT_UPDATED)
+                                {
+                                    break;
+                                }
+                                if (result == STUDENT_OUT_OF_MEMORY)
+                                {
+                                    fprintf(stderr, "Memory allocation error\n");
+                                    pause();
+                                    return 1;
+                                }
+                                const StudentIndexEntry *registered = studentIndexFind(&studentIndex, newID);
+                                printf("The ID %s is already registered in %s\n", newID, registered != NULL ? registered->section : "another section");
                             }
 
                             continue;
@@ -343,27 +407,43 @@ int main()
                             // Adds student
 
                             // Inputs student name
-                            char *name[100], *id[10];
+                            char name[100], id[10];
                             printf("\nEnter student name > ");
                             readLine(name, sizeof(name), stdin);
 
-                            // Inputs student ID
-                            printf("\nEnter student ID > ");
-                            readLine(id, sizeof(id), stdin);
-
-                            // Creates the student object and appends to data
-                            json_t *newStudentObject = json_object();
-                            json_object_set_new(newStudentObject, "name", json_string(name));
-                            json_object_set_new(newStudentObject, "id", json_string(id));
                             if (!json_is_array(studentsArrayInSection))
                             {
                                 fprintf(stderr, "error: 'studentsArrayInSection' is not an array\n");
                                 pause();
                                 return 1;
                             }
-                            json_array_append(studentsArrayInSection, newStudentObject);
 
-                            json_decref(newStudentObject); // JSON Decrease Reference: frees memory
+                            // Inputs student ID, until it is not used by another student
+                            // (an empty ID cancels)
+                            while (true)
+                            {
+                                printf("\nEnter student ID > ");
+                                readLine(id, sizeof(id), stdin);
+
+                                // Creates the student object and appends to data
+                                if (strlen(id) == 0)
+                                {
+                                    break;
+                                }
+                                StudentUpdateResult result = appendStudent(&studentIndex, studentsArrayInSection, chosenSection, name, id);
+                                if (result == STUDENT_UPDATED)
+                                {
+                                    break;
+                                }
+                                if (result == STUDENT_OUT_OF_MEMORY)
+                                {
+                                    fprintf(stderr, "Memory allocation error\n");
+                                    pause();
+                                    return 1;
+                                }
+                                const StudentIndexEntry *registered = studentIndexFind(&studentIndex, id);
+                                printf("The ID %s is already registered in %s\n", id, registered != NULL ? registered->section : "another section");
+                            }
                             continue;
                         }
 
@@ -374,14 +454,14 @@ int main()
                             while (true)
                             {
                                 // Inputs id of the student to be removed
-                                char *id[10];
+                                char id[10];
                                 printf("\nEnter the ID of the student to be removed > ");
                                 readLine(id, sizeof(id), stdin);
 
-                                // If the student with the inputted ID exists
-                                if (findObjectInArray(studentsArrayInSection, "id", id))
+                                // If the student with the inputted ID exists in this section
+                                if (findStudent(&studentIndex, jsonObject, chosenSection, id))
                                 {
-                                    removeObjectFromArray(studentsArrayInSection, "id", id);
+                                    removeStudent(&studentIndex, studentsArrayInSection, id);
                                     break;
                                 }
                                 else
@@ -425,6 +505,12 @@ int main()
                 printf("Enter the name of the section to be added > ");
                 readLine(sectionName, sizeof(sectionName), stdin);
 
+                // Replacing an existing section would drop its students
+                if (json_object_get(jsonObject, sectionName) != NULL)
+                {
+                    continue;
+                }
+
                 // Initializes the new key of the JSON which is the section name
                 // with an empty array (to where the student objects will be stored)
                 json_object_set_new(jsonObject, sectionName, json_array());
@@ -468,7 +554,8 @@ int main()
                         if (sectionNum > 0 && sectionNum <= sectionsNum)
                         {
                             int sectionIndex = sectionNum - 1;
-                            // Remove section from the `jsonObject`
+                            // Remove section from the index and the `jsonObject`
+                            removeSectionFromIndex(&studentIndex, json_object_get(jsonObject, sections[sectionIndex]), sections[sectionIndex]);
                             removeKey(jsonObject, sections[sectionIndex]);
                             // Remove section from the `sections` array
                             removeElementFromArrayOfStrings(sections, &sectionsNum, sectionIndex);
@@ -520,6 +607,7 @@ int main()
     fclose(file);
 
     // Frees resources
+    studentIndexFree(&studentIndex);
     free(json_string);
     json_decref(jsonObject);
 
@@ -0,0 +1,224 @@
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <jansson.h>
+
+#include "students-data-utils.h"
+#include "students-index.h"
+#include "students-import.h"
+
+typedef enum
+{
+    LINE_READ,
+    LINE_END_OF_FILE,
+    LINE_OUT_OF_MEMORY
+} ReadLineResult;
+
+// Reads one line of any length, growing `*buffer` as needed
+static ReadLineResult readLineDynamic(FILE *file, char **buffer, size_t *capacity)
+{
+    size_t length = 0;
+    while (true)
+    {
+        if (length + 1 >= *capacity)
+        {
+            size_t newCapacity = *capacity == 0 ? 256 : *capacity * 2;
+            char *newBuffer = realloc(*buffer, newCapacity);
+            if (newBuffer == NULL)
+            {
+                return LINE_OUT_OF_MEMORY;
+            }
+            *buffer = newBuffer;
+            *capacity = newCapacity;
+        }
+
+        if (fgets(*buffer + length, (int)(*capacity - length), file) == NULL)
+        {
+            return length > 0 ? LINE_READ : LINE_END_OF_FILE;
+        }
+        length += strlen(*buffer + length);
+        if (length > 0 && (*buffer)[length - 1] == '\n')
+        {
+            return LINE_READ;
+        }
+    }
+}
+
+// Removes the surrounding whitespace (including the \r of Windows line endings)
+static char *trim(char *str)
+{
+    while (isspace((unsigned char)*str))
+    {
+        str++;
+    }
+    char *end = str + strlen(str);
+    while (end > str && isspace((unsigned char)end[-1]))
+    {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+// Splits a line into fields in place, removing the quotes around quoted
+// fields ("" inside a quoted field is a literal quote)
+// Returns the number of fields found (at most `maxFields`)
+static int splitFields(char *line, char delimiter, char **fields, int maxFields)
+{
+    int fieldsNum = 0;
+    char *read = line;
+
+    while (fieldsNum < maxFields)
+    {
+        while (*read == ' ')
+        {
+            read++;
+        }
+
+        char *field = read;
+        char *write = read;
+        if (*read == '"')
+        {
+            read++;
+            while (*read != '\0')
+            {
+                if (*read == '"' && read[1] == '"')
+                {
+                    *write++ = '"';
+                    read += 2;
+                }
+                else if (*read == '"')
+                {
+                    read++;
+                    break;
+                }
+                else
+                {
+                    *write++ = *read++;
+                }
+            }
+        }
+        while (*read != '\0' && *read != delimiter)
+        {
+            *write++ = *read++;
+        }
+
+        bool lastField = *read == '\0';
+        read++;
+        *write = '\0';
+        fields[fieldsNum++] = trim(field);
+
+        if (lastField)
+        {
+            break;
+        }
+    }
+    return fieldsNum;
+}
+
+static bool isValidID(const char *id)
+{
+    const char *kind = analyzeString(id);
+    return strcmp(kind, "NUMBERS") == 0 || strcmp(kind, "NUMBERS_AND_LETTERS") == 0;
+}
+
+bool importRoster(const char *filename, json_t *jsonObject, StudentIndex *index, ImportStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        perror("Error opening file");
+        return false;
+    }
+    setvbuf(file, NULL, _IOFBF, 1 << 16);
+
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+
+    size_t length = strlen(filename);
+    bool tsvFile = length >= 4 && strcmp(filename + length - 4, ".tsv") == 0;
+    char delimiter = tsvFile ? '\t' : ',';
+
+    char *line = NULL;
+    size_t capacity = 0;
+    bool firstRow = true;
+    bool success = true;
+
+    ReadLineResult lineResult;
+    while ((lineResult = readLineDynamic(file, &line, &capacity)) == LINE_READ)
+    {
+        if (firstRow && strchr(line, '\t') != NULL)
+        {
+            delimiter = '\t';
+        }
+
+        char *fields[3];
+        int fieldsNum = splitFields(line, delimiter, fields, 3);
+
+        if (fieldsNum == 1 && fields[0][0] == '\0')
+        {
+            firstRow = false;
+            continue; // Blank line
+        }
+
+        // Header row, ex. "course_and_section,name,id"
+        if (firstRow && fieldsNum == 3 && !isValidID(fields[2]))
+        {
+            firstRow = false;
+            continue;
+        }
+        firstRow = false;
+        stats->rows++;
+
+        if (fieldsNum != 3 || fields[0][0] == '\0' || fields[1][0] == '\0' || !isValidID(fields[2]))
+        {
+            stats->invalid++;
+            continue;
+        }
+
+        if (studentIndexFind(index, fields[2]) != NULL)
+        {
+            stats->duplicates++;
+            continue;
+        }
+
+        // A new section is only added with its first student
+        const char *section = fields[0];
+        json_t *sectionArray = json_object_get(jsonObject, section);
+        if (sectionArray == NULL)
+        {
+            sectionArray = json_array();
+            if (sectionArray == NULL || json_object_set_new(jsonObject, section, sectionArray) != 0)
+            {
+                fprintf(stderr, "Memory allocation error\n");
+                success = false;
+                break;
+            }
+        }
+
+        if (appendStudent(index, sectionArray, section, fields[1], fields[2]) != STUDENT_UPDATED)
+        {
+            fprintf(stderr, "Memory allocation error\n");
+            success = false;
+            break;
+        }
+        stats->imported++;
+    }
+    if (lineResult == LINE_OUT_OF_MEMORY)
+    {
+        fprintf(stderr, "Memory allocation error\n");
+        success = false;
+    }
+
+    free(line);
+    fclose(file);
+
+    stats->seconds = secondsSince(&start);
+    return success;
+}
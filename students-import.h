@@ -0,0 +1,24 @@
+#pragma once
+
+#include <jansson.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "students-index.h"
+
+typedef struct
+{
+    size_t rows;       // Data rows read (the header row is not counted)
+    size_t imported;   // Students added to the roster
+    size_t duplicates; // Rows whose ID is already registered
+    size_t invalid;    // Rows with missing fields or an invalid ID
+    double seconds;    // Time spent reading and merging
+} ImportStats;
+
+// Merges a registrar export into the roster
+// Each row has 3 fields: course_and_section, name, id
+// The fields are separated by tabs if the file ends with ".tsv" or the first
+// row has a tab, otherwise by commas (fields may be quoted with "")
+// An optional header row is recognized by its ID field not being a valid ID
+// The file is read one row at a time, so its size does not matter
+bool importRoster(const char *filename, json_t *jsonObject, StudentIndex *index, ImportStats *stats);
@@ -0,0 +1,331 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <jansson.h>
+
+#include "students-index.h"
+
+// FNV-1a string hash
+static uint64_t hashString(const char *str)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (const unsigned char *p = (const unsigned char *)str; *p != '\0'; p++)
+    {
+        hash ^= *p;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static char *duplicateString(const char *str)
+{
+    size_t length = strlen(str) + 1;
+    char *copy = malloc(length);
+    if (copy != NULL)
+    {
+        memcpy(copy, str, length);
+    }
+    return copy;
+}
+
+// Returns the slot holding `id`, or the empty slot where it would be inserted
+static size_t findSlot(const StudentIndex *index, const char *id)
+{
+    size_t mask = index->capacity - 1;
+    size_t slot = hashString(id) & mask;
+    while (index->slots[slot].id != NULL && strcmp(index->slots[slot].id, id) != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Doubles the table so that it stays at most half full
+static bool growIndex(StudentIndex *index)
+{
+    size_t oldCapacity = index->capacity;
+    StudentIndexEntry *oldSlots = index->slots;
+
+    size_t newCapacity = oldCapacity == 0 ? 64 : oldCapacity * 2;
+    StudentIndexEntry *newSlots = calloc(newCapacity, sizeof(StudentIndexEntry));
+    if (newSlots == NULL)
+    {
+        return false;
+    }
+
+    index->slots = newSlots;
+    index->capacity = newCapacity;
+    for (size_t i = 0; i < oldCapacity; i++)
+    {
+        if (oldSlots[i].id != NULL)
+        {
+            index->slots[findSlot(index, oldSlots[i].id)] = oldSlots[i];
+        }
+    }
+    free(oldSlots);
+    return true;
+}
+
+bool studentIndexBuild(StudentIndex *index, json_t *jsonObject)
+{
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+    if (!growIndex(index))
+    {
+        return false;
+    }
+
+    const char *section;
+    json_t *sectionArray;
+    json_object_foreach(jsonObject, section, sectionArray)
+    {
+        size_t position;
+        json_t *studentObject;
+        json_array_foreach(sectionArray, position, studentObject)
+        {
+            const char *id = json_string_value(json_object_get(studentObject, "id"));
+            // Duplicate IDs already in the file keep their first occurrence
+            if (id != NULL && studentIndexFind(index, id) == NULL)
+            {
+                if (!studentIndexAdd(index, id, section, position))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void studentIndexFree(StudentIndex *index)
+{
+    for (size_t i = 0; i < index->capacity; i++)
+    {
+        free(index->slots[i].id);
+        free(index->slots[i].section);
+    }
+    free(index->slots);
+    index->slots = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
+
+const StudentIndexEntry *studentIndexFind(const StudentIndex *index, const char *id)
+{
+    if (index->capacity == 0)
+    {
+        return NULL;
+    }
+    const StudentIndexEntry *entry = &index->slots[findSlot(index, id)];
+    return entry->id != NULL ? entry : NULL;
+}
+
+bool studentIndexAdd(StudentIndex *index, const char *id, const char *section, size_t position)
+{
+    if ((index->count + 1) * 2 > index->capacity && !growIndex(index))
+    {
+        return false;
+    }
+
+    // Copied first, so that a failed allocation leaves the entry as it was
+    char *sectionCopy = duplicateString(section);
+    if (sectionCopy == NULL)
+    {
+        return false;
+    }
+
+    StudentIndexEntry *entry = &index->slots[findSlot(index, id)];
+    if (entry->id != NULL)
+    {
+        // Already indexed, only moves it
+        free(entry->section);
+    }
+    else
+    {
+        entry->id = duplicateString(id);
+        if (entry->id == NULL)
+        {
+            free(sectionCopy);
+            return false;
+        }
+        index->count++;
+    }
+    entry->section = sectionCopy;
+    entry->position = position;
+
+    return true;
+}
+
+void studentIndexRemove(StudentIndex *index, const char *id)
+{
+    if (index->capacity == 0)
+    {
+        return;
+    }
+
+    size_t mask = index->capacity - 1;
+    size_t slot = findSlot(index, id);
+    if (index->slots[slot].id == NULL)
+    {
+        return;
+    }
+
+    free(index->slots[slot].id);
+    free(index->slots[slot].section);
+    index->slots[slot].id = NULL;
+    index->slots[slot].section = NULL;
+    index->count--;
+
+    // Shifts back the entries that follow in the probe sequence, so that
+    // no entry ends up after an empty slot it was probed past
+    size_t emptySlot = slot;
+    size_t next = (slot + 1) & mask;
+    while (index->slots[next].id != NULL)
+    {
+        size_t home = hashString(index->slots[next].id) & mask;
+        // Moves the entry if its home slot is not between the empty slot and itself
+        bool canMove = emptySlot <= next ? (home <= emptySlot || home > next) : (home <= emptySlot && home > next);
+        if (canMove)
+        {
+            index->slots[emptySlot] = index->slots[next];
+            index->slots[next].id = NULL;
+            index->slots[next].section = NULL;
+            emptySlot = next;
+        }
+        next = (next + 1) & mask;
+    }
+}
+
+// Gets the student object with the ID, if the student is in `section`
+json_t *findStudent(const StudentIndex *index, json_t *jsonObject, const char *section, const char *id)
+{
+    const StudentIndexEntry *entry = studentIndexFind(index, id);
+    if (entry == NULL || strcmp(entry->section, section) != 0)
+    {
+        return NULL;
+    }
+    return json_array_get(json_object_get(jsonObject, section), entry->position);
+}
+
+// Appends a new student to the section, unless the ID is already registered
+// On STUDENT_OUT_OF_MEMORY, neither the section array nor the index is changed
+StudentUpdateResult appendStudent(StudentIndex *index, json_t *sectionArray, const char *section, const char *name, const char *id)
+{
+    if (studentIndexFind(index, id) != NULL)
+    {
+        return STUDENT_DUPLICATE_ID;
+    }
+
+    json_t *newStudentObject = json_object();
+    if (newStudentObject == NULL)
+    {
+        return STUDENT_OUT_OF_MEMORY;
+    }
+    if (json_object_set_new(newStudentObject, "name", json_string(name)) != 0 ||
+        json_object_set_new(newStudentObject, "id", json_string(id)) != 0)
+    {
+        json_decref(newStudentObject);
+        return STUDENT_OUT_OF_MEMORY;
+    }
+    // Takes the reference even if it fails
+    if (json_array_append_new(sectionArray, newStudentObject) != 0)
+    {
+        return STUDENT_OUT_OF_MEMORY;
+    }
+
+    size_t position = json_array_size(sectionArray) - 1;
+    if (!studentIndexAdd(index, id, section, position))
+    {
+        json_array_remove(sectionArray, position);
+        return STUDENT_OUT_OF_MEMORY;
+    }
+    return STUDENT_UPDATED;
+}
+
+// Changes the ID of a student, unless another student has the new ID
+// On STUDENT_OUT_OF_MEMORY, neither the student nor the index is changed
+StudentUpdateResult changeStudentID(StudentIndex *index, json_t *studentObject, const char *newID)
+{
+    const char *oldID = json_string_value(json_object_get(studentObject, "id"));
+    if (oldID != NULL && strcmp(oldID, newID) == 0)
+    {
+        return STUDENT_UPDATED;
+    }
+    if (studentIndexFind(index, newID) != NULL)
+    {
+        return STUDENT_DUPLICATE_ID;
+    }
+
+    json_t *newIDValue = json_string(newID);
+    if (newIDValue == NULL)
+    {
+        return STUDENT_OUT_OF_MEMORY;
+    }
+
+    const StudentIndexEntry *entry = oldID != NULL ? studentIndexFind(index, oldID) : NULL;
+    if (entry != NULL)
+    {
+        // Copies the location, the entry moves if the index grows
+        char *section = duplicateString(entry->section);
+        size_t position = entry->position;
+        if (section == NULL || !studentIndexAdd(index, newID, section, position))
+        {
+            free(section);
+            json_decref(newIDValue);
+            return STUDENT_OUT_OF_MEMORY;
+        }
+        free(section);
+        // Before the old ID string is released by the object
+        studentIndexRemove(index, oldID);
+    }
+
+    // Replaces the existing "id" value, which does not allocate
+    json_object_set_new(studentObject, "id", newIDValue);
+    return STUDENT_UPDATED;
+}
+
+// Removes the student from the section array and the index
+// The students after it move up one position in the array
+void removeStudent(StudentIndex *index, json_t *sectionArray, const char *id)
+{
+    const StudentIndexEntry *entry = studentIndexFind(index, id);
+    if (entry == NULL)
+    {
+        return;
+    }
+    size_t position = entry->position;
+
+    json_array_remove(sectionArray, position);
+    studentIndexRemove(index, id);
+
+    for (size_t i = position; i < json_array_size(sectionArray); i++)
+    {
+        const char *movedID = json_string_value(json_object_get(json_array_get(sectionArray, i), "id"));
+        StudentIndexEntry *moved = movedID != NULL ? (StudentIndexEntry *)studentIndexFind(index, movedID) : NULL;
+        if (moved != NULL && moved->position == i + 1)
+        {
+            moved->position = i;
+        }
+    }
+}
+
+// Removes every student of a section from the index (before the section is removed)
+void removeSectionFromIndex(StudentIndex *index, json_t *sectionArray, const char *section)
+{
+    size_t position;
+    json_t *studentObject;
+    json_array_foreach(sectionArray, position, studentObject)
+    {
+        const char *id = json_string_value(json_object_get(studentObject, "id"));
+        const StudentIndexEntry *entry = id != NULL ? studentIndexFind(index, id) : NULL;
+        // Only if the entry is this student and not a duplicate ID in another section
+        if (entry != NULL && entry->position == position && strcmp(entry->section, section) == 0)
+        {
+            studentIndexRemove(index, id);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <jansson.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Where a student ID is stored in students-data.json:
+// jsonObject[section][position]
+typedef struct
+{
+    char *id; // NULL if the slot is empty
+    char *section;
+    size_t position;
+} StudentIndexEntry;
+
+// Hash table (open addressing, linear probing) of every student ID of
+// every section, kept up to date alongside the jansson document so that
+// finding a student or checking for a duplicate ID does not scan the sections
+typedef struct
+{
+    StudentIndexEntry *slots;
+    size_t capacity; // Always a power of two
+    size_t count;
+} StudentIndex;
+
+// Result of adding a student or changing a student's ID
+typedef enum
+{
+    STUDENT_UPDATED,
+    STUDENT_DUPLICATE_ID,
+    STUDENT_OUT_OF_MEMORY
+} StudentUpdateResult;
+
+bool studentIndexBuild(StudentIndex *index, json_t *jsonObject);
+
+void studentIndexFree(StudentIndex *index);
+
+const StudentIndexEntry *studentIndexFind(const StudentIndex *index, const char *id);
+
+bool studentIndexAdd(StudentIndex *index, const char *id, const char *section, size_t position);
+
+void studentIndexRemove(StudentIndex *index, const char *id);
+
+json_t *findStudent(const StudentIndex *index, json_t *jsonObject, const char *section, const char *id);
+
+StudentUpdateResult appendStudent(StudentIndex *index, json_t *sectionArray, const char *section, const char *name, const char *id);
+
+StudentUpdateResult changeStudentID(StudentIndex *index, json_t *studentObject, const char *newID);
+
+void removeStudent(StudentIndex *index, json_t *sectionArray, const char *id);
+
+void removeSectionFromIndex(StudentIndex *index, json_t *sectionArray, const char *section);
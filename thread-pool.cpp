@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "thread-pool.hpp"
+
+// Worker index of the current thread and the pool it belongs to
+static thread_local int currentWorkerIndex = -1;
+static thread_local const ThreadPool *currentPool = nullptr;
+
+ThreadPool::ThreadPool(int threadsNum)
+{
+    if (threadsNum <= 0)
+    {
+        threadsNum = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    for (int i = 0; i < threadsNum; ++i)
+    {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (int i = 0; i < threadsNum; ++i)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    std::size_t queueIndex;
+    if (currentPool == this)
+    {
+        queueIndex = currentWorkerIndex;
+    }
+    else
+    {
+        queueIndex = nextQueue++ % queues.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queues[queueIndex]->mutex);
+        queues[queueIndex]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        queuedTasks++;
+        unfinishedTasks++;
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allDone.wait(lock, [this]
+                 { return unfinishedTasks == 0; });
+
+    if (firstError)
+    {
+        std::exception_ptr error = firstError;
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+int ThreadPool::size() const
+{
+    return static_cast<int>(workers.size());
+}
+
+int ThreadPool::currentWorker()
+{
+    return currentWorkerIndex;
+}
+
+void ThreadPool::workerLoop(int worker)
+{
+    currentWorkerIndex = worker;
+    currentPool = this;
+
+    while (true)
+    {
+        {
+            // Reserves one of the queued tasks, so the loop in `takeTask`
+            // is guaranteed to find a task in one of the queues
+            std::unique_lock<std::mutex> lock(stateMutex);
+            taskAvailable.wait(lock, [this]
+                               { return stopping || queuedTasks > 0; });
+            if (queuedTasks == 0)
+            {
+                return; // Stopping and nothing left to do
+            }
+            queuedTasks--;
+        }
+
+        std::function<void()> task;
+        while (!takeTask(worker, task))
+        {
+            std::this_thread::yield();
+        }
+
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (!firstError)
+            {
+                firstError = std::current_exception();
+            }
+        }
+
+        if (--unfinishedTasks == 0)
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            allDone.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::takeTask(int worker, std::function<void()> &task)
+{
+    // Own queue first, oldest task first
+    {
+        WorkerQueue &own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // Then steals the newest task of another worker
+    std::size_t queuesNum = queues.size();
+    for (std::size_t offset = 1; offset < queuesNum; ++offset)
+    {
+        WorkerQueue &victim = *queues[(worker + offset) % queuesNum];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads with work stealing
+//
+// Every worker has its own task queue. A worker takes tasks from the front
+// of its own queue, and when it runs out, steals from the back of the other
+// workers' queues, so uneven tasks still keep every core busy
+class ThreadPool
+{
+public:
+    // 0 threads means one per core
+    explicit ThreadPool(int threadsNum = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Queues the task on the calling worker's own queue when called from a
+    // task, otherwise distributes the tasks over the workers in turn
+    void submit(std::function<void()> task);
+
+    // Blocks until every submitted task is done. If a task threw an
+    // exception, the first one is rethrown here
+    void wait();
+
+    int size() const;
+
+    // Index (0 to size() - 1) of the worker running the calling task, or -1
+    // when not called from a task. Useful to give each worker its own
+    // reusable resources
+    static int currentWorker();
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(int worker);
+    bool takeTask(int worker, std::function<void()> &task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<std::size_t> nextQueue{0};
+    std::atomic<std::size_t> unfinishedTasks{0};
+
+    // Used to put idle workers to sleep and to wake up `wait`
+    std::mutex stateMutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allDone;
+    std::size_t queuedTasks = 0;
+    bool stopping = false;
+
+    std::exception_ptr firstError;
+};
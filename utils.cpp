@@ -92,16 +92,89 @@ std::string datetimeStringByFormat(const char *format)
     std::time_t currentTime = std::chrono::system_clock::to_time_t(now);
 
     // Convert time_t to a tm structure (broken down time i.e. year, month, day, etc.)
-    std::tm *localTime = std::localtime(&currentTime);
+    std::tm localTime{};
+    toLocalTime(currentTime, localTime);
 
     // Format the date as a string
     std::ostringstream oss; // output string stream
-    oss << std::put_time(localTime, format);
+    oss << std::put_time(&localTime, format);
 
     // Returns the formatted date as a string
     return oss.str();
 }
 
+bool toLocalTime(std::time_t time, std::tm &localTime)
+{
+#ifdef _WIN32
+    return localtime_s(&localTime, &time) == 0;
+#else
+    return localtime_r(&time, &localTime) != nullptr;
+#endif
+}
+
+ClockStamp ClockService::now()
+{
+    std::time_t currentTime = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Formats again only outside of the cached minute (also if the clock was set back)
+    if (currentTime < minuteStart || currentTime >= nextMinute)
+    {
+        std::tm localTime{};
+        if (!toLocalTime(currentTime, localTime))
+        {
+            return cached;
+        }
+        std::strftime(cached.date, sizeof(cached.date), "%a %m-%d-%Y", &localTime);
+        std::strftime(cached.time, sizeof(cached.time), "%H:%M", &localTime);
+
+        // tm_sec can be 60 on a leap second
+        minuteStart = currentTime - std::min(localTime.tm_sec, 59);
+        nextMinute = minuteStart + 60;
+    }
+    return cached;
+}
+
+// FNV-1a, a fast non-cryptographic hash used for the lookup tables
+std::uint64_t fnv1aHash(std::string_view text)
+{
+    std::uint64_t hash = 14695981039346656037ull; // Offset basis
+    for (unsigned char character : text)
+    {
+        hash ^= character;
+        hash *= 1099511628211ull; // FNV prime
+    }
+    return hash;
+}
+
+// Function that checks whether a command line flag (ex. "--force") is given
+bool hasOption(int argc, char *argv[], const std::string &option)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (option == argv[i])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Function that gets the value following a command line option (ex. "--jobs 4"),
+// or `defaultValue` if the option is not given
+std::string getOptionValue(int argc, char *argv[], const std::string &option, const std::string &defaultValue)
+{
+    for (int i = 1; i < argc - 1; ++i)
+    {
+        if (option == argv[i])
+        {
+            return argv[i + 1];
+        }
+    }
+    return defaultValue;
+}
+
 void pause()
 {
     std::cout << "\n**** Program ended ****" << std::endl;
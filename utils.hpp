@@ -1,4 +1,10 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 bool isFileInCurrentDirectory(const std::string &filename);
@@ -11,6 +17,39 @@ std::vector<std::string> getExcelFiles(std::string path);
 
 std::string datetimeStringByFormat(const char *format);
 
+// Thread-safe std::localtime (localtime_r/localtime_s). Returns false on failure
+bool toLocalTime(std::time_t time, std::tm &localTime);
+
+// Date and time of a scan, formatted. Fixed-size so it is copied without allocating
+struct ClockStamp
+{
+    char date[16]; // "%a %m-%d-%Y" (ex. "Tue 11-29-2023")
+    char time[6];  // "%H:%M" (ex. "15:45")
+};
+
+// Current local date and time of the scans. The formatted strings are cached
+// and only formatted again when a new minute starts (a new day always starts
+// with a new minute), so a call is a clock read and a copy. Thread-safe
+class ClockService
+{
+public:
+    ClockStamp now();
+
+private:
+    std::mutex mutex;
+    ClockStamp cached{};
+
+    // The minute of `cached`, as [minuteStart, nextMinute)
+    std::time_t minuteStart = 0;
+    std::time_t nextMinute = 0;
+};
+
+std::uint64_t fnv1aHash(std::string_view text);
+
+bool hasOption(int argc, char *argv[], const std::string &option);
+
+std::string getOptionValue(int argc, char *argv[], const std::string &option, const std::string &defaultValue);
+
 template <typename T>
 bool isInArray(const T arr[], int size, const T &value);
 
@@ -0,0 +1,59 @@
+#include <string>
+#include <unordered_map>
+
+#include <OpenXLSX.hpp>
+
+#include "workbook-catalog.hpp"
+
+using namespace OpenXLSX;
+
+void WorkbookCatalog::load(XLDocument &doc)
+{
+    this->doc = &doc;
+    sheets.clear();
+    for (const auto &name : doc.workbook().worksheetNames())
+    {
+        sheets.try_emplace(name);
+    }
+}
+
+bool WorkbookCatalog::hasSheet(const std::string &name) const
+{
+    return sheets.find(name) != sheets.end();
+}
+
+bool WorkbookCatalog::addSheet(const std::string &name)
+{
+    if (hasSheet(name))
+    {
+        return false;
+    }
+    doc->workbook().addWorksheet(name);
+    sheets.try_emplace(name);
+    return true;
+}
+
+WorkbookCatalog::Entry &WorkbookCatalog::entry(const std::string &name)
+{
+    return sheets.at(name);
+}
+
+XLWorksheet &WorkbookCatalog::worksheet(const std::string &name)
+{
+    Entry &sheet = entry(name);
+    if (!sheet.worksheet)
+    {
+        sheet.worksheet = doc->workbook().worksheet(name);
+    }
+    return *sheet.worksheet;
+}
+
+SheetIndex &WorkbookCatalog::index(const std::string &name)
+{
+    Entry &sheet = entry(name);
+    if (!sheet.index)
+    {
+        sheet.index = SheetIndex::build(worksheet(name));
+    }
+    return *sheet.index;
+}
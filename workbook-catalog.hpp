@@ -0,0 +1,41 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <OpenXLSX.hpp>
+
+#include "sheet-index.hpp"
+
+// The worksheets of an opened excel file by name. The sheet names are read
+// once when the catalog is loaded, and each sheet's handle and header index
+// (see sheet-index.hpp) once on first use, so that every lookup afterwards
+// is a hash map access. Sheets must be added through the catalog to keep
+// it up to date
+class WorkbookCatalog
+{
+public:
+    void load(OpenXLSX::XLDocument &doc);
+
+    bool hasSheet(const std::string &name) const;
+
+    // Adds the sheet to the workbook if it is missing. Returns true if added
+    bool addSheet(const std::string &name);
+
+    // The sheet must exist
+    OpenXLSX::XLWorksheet &worksheet(const std::string &name);
+    SheetIndex &index(const std::string &name);
+
+private:
+    struct Entry
+    {
+        std::optional<OpenXLSX::XLWorksheet> worksheet;
+        std::optional<SheetIndex> index;
+    };
+
+    Entry &entry(const std::string &name);
+
+    OpenXLSX::XLDocument *doc = nullptr;
+    std::unordered_map<std::string, Entry> sheets;
+};
@@ -0,0 +1,334 @@
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "xlsx-stream-writer.hpp"
+
+namespace fs = std::filesystem;
+
+static const char *xmlDeclaration = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n";
+static const char *spreadsheetNamespace = "http://schemas.openxmlformats.org/spreadsheetml/2006/main";
+
+std::string columnName(int column)
+{
+    std::string name;
+    while (column > 0)
+    {
+        int remainder = (column - 1) % 26;
+        name.insert(name.begin(), static_cast<char>('A' + remainder));
+        column = (column - 1) / 26;
+    }
+    return name;
+}
+
+void appendXmlEscaped(std::string &out, std::string_view text)
+{
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '&':
+            out += "&amp;";
+            break;
+        case '<':
+            out += "&lt;";
+            break;
+        case '>':
+            out += "&gt;";
+            break;
+        case '"':
+            out += "&quot;";
+            break;
+        case '\'':
+            out += "&apos;";
+            break;
+        default:
+            out.push_back(c);
+        }
+    }
+}
+
+XlsxStreamWriter::~XlsxStreamWriter()
+{
+    discard();
+}
+
+bool XlsxStreamWriter::open(const std::string &filename)
+{
+    discard();
+    this->filename = filename;
+    sheetNames.clear();
+    inSheet = false;
+    sharedStrings = StringInterner();
+    stringReferences = 0;
+    writing = zip.open(filename + ".tmp");
+    return writing;
+}
+
+void XlsxStreamWriter::discard()
+{
+    if (writing)
+    {
+        zip.discard();
+        std::remove((filename + ".tmp").c_str());
+        writing = false;
+    }
+}
+
+bool XlsxStreamWriter::beginSheet(const std::string &name)
+{
+    if (inSheet)
+    {
+        endSheet();
+    }
+    sheetNames.push_back(name);
+    if (!zip.beginEntry("xl/worksheets/sheet" + std::to_string(sheetNames.size()) + ".xml"))
+    {
+        return false;
+    }
+    zip.write(xmlDeclaration);
+    zip.write("<worksheet xmlns=\"");
+    zip.write(spreadsheetNamespace);
+    zip.write("\"><sheetData>");
+    inSheet = true;
+    return true;
+}
+
+void XlsxStreamWriter::endSheet()
+{
+    zip.write("</sheetData></worksheet>");
+    inSheet = false;
+}
+
+void XlsxStreamWriter::appendCell(std::string &xml, int column, const std::string &rowReference, StringInterner::Symbol sharedString)
+{
+    xml += "<c r=\"";
+    xml += columnName(column);
+    xml += rowReference;
+    xml += "\" t=\"s\"><v>";
+    xml += std::to_string(sharedString);
+    xml += "</v></c>";
+}
+
+void SheetBuffer::beginRow(int row)
+{
+    rowNumber = row;
+}
+
+void SheetBuffer::cell(int column, std::string_view text)
+{
+    cells.push_back(Cell{rowNumber, column, strings.intern(text)});
+}
+
+std::string XlsxStreamWriter::sheetXml(const SheetBuffer &sheet, const std::vector<StringInterner::Symbol> &sharedStringOf)
+{
+    std::string xml;
+    std::string reference;
+    int row = 0;
+    for (const auto &cell : sheet.cells)
+    {
+        if (cell.row != row)
+        {
+            if (row != 0)
+            {
+                xml += "</row>";
+            }
+            row = cell.row;
+            reference = std::to_string(row);
+            xml += "<row r=\"";
+            xml += reference;
+            xml += "\">";
+        }
+        appendCell(xml, cell.column, reference, sharedStringOf[cell.text]);
+    }
+    if (row != 0)
+    {
+        xml += "</row>";
+    }
+    return xml;
+}
+
+bool XlsxStreamWriter::writeSheets(const std::vector<std::string> &names, const std::vector<SheetBuffer> &sheets, ThreadPool &pool)
+{
+    // The sheets' strings in the shared strings table. Cheap and done in
+    // order, so that the table is the same for any number of threads
+    std::vector<std::vector<StringInterner::Symbol>> sharedStringsOf(sheets.size());
+    for (std::size_t i = 0; i < sheets.size(); ++i)
+    {
+        const StringInterner &strings = sheets[i].strings;
+        sharedStringsOf[i].resize(strings.size());
+        for (StringInterner::Symbol symbol = 0; symbol < strings.size(); ++symbol)
+        {
+            sharedStringsOf[i][symbol] = sharedStrings.intern(strings.view(symbol));
+        }
+        stringReferences += sheets[i].cells.size();
+    }
+
+    std::vector<std::string> xml(sheets.size());
+    for (std::size_t i = 0; i < sheets.size(); ++i)
+    {
+        pool.submit([&xml, &sheets, &sharedStringsOf, i]
+                    { xml[i] = sheetXml(sheets[i], sharedStringsOf[i]); });
+    }
+    pool.wait();
+
+    for (std::size_t i = 0; i < sheets.size(); ++i)
+    {
+        if (!beginSheet(names[i]))
+        {
+            return false;
+        }
+        zip.write(xml[i]);
+        std::string().swap(xml[i]);
+    }
+    return true;
+}
+
+// The parts of the package other than the sheets: the shared strings,
+// the workbook and its relationships, the styles and the properties
+void XlsxStreamWriter::writeParts()
+{
+    std::string xml;
+
+    zip.beginEntry("xl/sharedStrings.xml");
+    xml = xmlDeclaration;
+    xml += "<sst xmlns=\"";
+    xml += spreadsheetNamespace;
+    xml += "\" count=\"" + std::to_string(stringReferences) + "\" uniqueCount=\"" + std::to_string(sharedStrings.size()) + "\">";
+    zip.write(xml);
+    for (StringInterner::Symbol symbol = 0; symbol < sharedStrings.size(); ++symbol)
+    {
+        xml = "<si><t xml:space=\"preserve\">";
+        appendXmlEscaped(xml, sharedStrings.view(symbol));
+        xml += "</t></si>";
+        zip.write(xml);
+    }
+    zip.write("</sst>");
+
+    zip.beginEntry("xl/workbook.xml");
+    xml = xmlDeclaration;
+    xml += "<workbook xmlns=\"";
+    xml += spreadsheetNamespace;
+    xml += "\" xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\"><sheets>";
+    for (std::size_t i = 0; i < sheetNames.size(); ++i)
+    {
+        xml += "<sheet name=\"";
+        appendXmlEscaped(xml, sheetNames[i]);
+        xml += "\" sheetId=\"" + std::to_string(i + 1) + "\" r:id=\"rId" + std::to_string(i + 1) + "\"/>";
+    }
+    xml += "</sheets></workbook>";
+    zip.write(xml);
+
+    zip.beginEntry("xl/_rels/workbook.xml.rels");
+    xml = xmlDeclaration;
+    xml += "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">";
+    for (std::size_t i = 0; i < sheetNames.size(); ++i)
+    {
+        xml += "<Relationship Id=\"rId" + std::to_string(i + 1) +
+               "\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet" +
+               std::to_string(i + 1) + ".xml\"/>";
+    }
+    xml += "<Relationship Id=\"rId" + std::to_string(sheetNames.size() + 1) +
+           "\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/sharedStrings\" Target=\"sharedStrings.xml\"/>";
+    xml += "<Relationship Id=\"rId" + std::to_string(sheetNames.size() + 2) +
+           "\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles\" Target=\"styles.xml\"/>";
+    xml += "</Relationships>";
+    zip.write(xml);
+
+    // A single default style
+    zip.beginEntry("xl/styles.xml");
+    xml = xmlDeclaration;
+    xml += "<styleSheet xmlns=\"";
+    xml += spreadsheetNamespace;
+    xml += "\"><fonts count=\"1\"><font><sz val=\"11\"/><name val=\"Calibri\"/></font></fonts>"
+           "<fills count=\"2\"><fill><patternFill patternType=\"none\"/></fill><fill><patternFill patternType=\"gray125\"/></fill></fills>"
+           "<borders count=\"1\"><border><left/><right/><top/><bottom/><diagonal/></border></borders>"
+           "<cellStyleXfs count=\"1\"><xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\"/></cellStyleXfs>"
+           "<cellXfs count=\"1\"><xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\"/></cellXfs>"
+           "<cellStyles count=\"1\"><cellStyle name=\"Normal\" xfId=\"0\" builtinId=\"0\"/></cellStyles></styleSheet>";
+    zip.write(xml);
+
+    // The sheet names are also listed in the application properties, which
+    // OpenXLSX keeps up to date when a sheet is added later
+    zip.beginEntry("docProps/app.xml");
+    xml = xmlDeclaration;
+    xml += "<Properties xmlns=\"http://schemas.openxmlformats.org/officeDocument/2006/extended-properties\" "
+           "xmlns:vt=\"http://schemas.openxmlformats.org/officeDocument/2006/docPropsVTypes\"><Application>qrar</Application>"
+           "<HeadingPairs><vt:vector size=\"2\" baseType=\"variant\"><vt:variant><vt:lpstr>Worksheets</vt:lpstr></vt:variant><vt:variant><vt:i4>";
+    xml += std::to_string(sheetNames.size());
+    xml += "</vt:i4></vt:variant></vt:vector></HeadingPairs><TitlesOfParts><vt:vector size=\"" + std::to_string(sheetNames.size()) + "\" baseType=\"lpstr\">";
+    for (const auto &name : sheetNames)
+    {
+        xml += "<vt:lpstr>";
+        appendXmlEscaped(xml, name);
+        xml += "</vt:lpstr>";
+    }
+    xml += "</vt:vector></TitlesOfParts></Properties>";
+    zip.write(xml);
+
+    zip.beginEntry("docProps/core.xml");
+    xml = xmlDeclaration;
+    xml += "<cp:coreProperties xmlns:cp=\"http://schemas.openxmlformats.org/package/2006/metadata/core-properties\" "
+           "xmlns:dc=\"http://purl.org/dc/elements/1.1/\" xmlns:dcterms=\"http://purl.org/dc/terms/\" "
+           "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"><dc:creator>qrar</dc:creator></cp:coreProperties>";
+    zip.write(xml);
+
+    zip.beginEntry("_rels/.rels");
+    xml = xmlDeclaration;
+    xml += "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+           "<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument\" Target=\"xl/workbook.xml\"/>"
+           "<Relationship Id=\"rId2\" Type=\"http://schemas.openxmlformats.org/package/2006/relationships/metadata/core-properties\" Target=\"docProps/core.xml\"/>"
+           "<Relationship Id=\"rId3\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/extended-properties\" Target=\"docProps/app.xml\"/>"
+           "</Relationships>";
+    zip.write(xml);
+
+    zip.beginEntry("[Content_Types].xml");
+    xml = xmlDeclaration;
+    xml += "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+           "<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+           "<Default Extension=\"xml\" ContentType=\"application/xml\"/>"
+           "<Override PartName=\"/xl/workbook.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml\"/>";
+    for (std::size_t i = 0; i < sheetNames.size(); ++i)
+    {
+        xml += "<Override PartName=\"/xl/worksheets/sheet" + std::to_string(i + 1) +
+               ".xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml\"/>";
+    }
+    xml += "<Override PartName=\"/xl/sharedStrings.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sharedStrings+xml\"/>"
+           "<Override PartName=\"/xl/styles.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml\"/>"
+           "<Override PartName=\"/docProps/core.xml\" ContentType=\"application/vnd.openxmlformats-package.core-properties+xml\"/>"
+           "<Override PartName=\"/docProps/app.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.extended-properties+xml\"/>"
+           "</Types>";
+    zip.write(xml);
+}
+
+bool XlsxStreamWriter::close()
+{
+    if (!writing)
+    {
+        return false;
+    }
+    if (inSheet)
+    {
+        endSheet();
+    }
+    writeParts();
+
+    std::string temporaryFilename = filename + ".tmp";
+    if (!zip.close())
+    {
+        std::remove(temporaryFilename.c_str());
+        writing = false;
+        return false;
+    }
+
+    std::error_code error;
+    fs::rename(temporaryFilename, filename, error);
+    if (error)
+    {
+        std::remove(temporaryFilename.c_str());
+    }
+    writing = false;
+    return !error;
+}
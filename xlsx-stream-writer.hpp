@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "string-interner.hpp"
+#include "thread-pool.hpp"
+#include "zip-stream-writer.hpp"
+
+// The cells of one sheet, built apart from the writer (ex. on a worker
+// thread) with their own string table, then added to the workbook by
+// XlsxStreamWriter::writeSheets
+class SheetBuffer
+{
+public:
+    // Rows must be written in increasing order, and the cells of a row in
+    // increasing column order. Rows and columns start at 1
+    void beginRow(int row);
+    void cell(int column, std::string_view text);
+
+private:
+    friend class XlsxStreamWriter;
+
+    struct Cell
+    {
+        int row;
+        int column;
+        StringInterner::Symbol text;
+    };
+
+    StringInterner strings;
+    std::vector<Cell> cells;
+    int rowNumber = 0;
+};
+
+// Writes an xlsx file in one pass: each batch of sheets is written straight
+// into the zip archive, instead of building every sheet's XML in memory like
+// OpenXLSX does. Only the shared strings (each distinct text once) and the
+// sheet names are kept until the end
+//
+// Every cell is a shared string, like the cells written by the exporter.
+// The file is written to "[filename].tmp", then renamed by `close`. The
+// temporary file is removed if anything fails, or if the writer is
+// destroyed before `close`
+class XlsxStreamWriter
+{
+public:
+    XlsxStreamWriter() = default;
+    XlsxStreamWriter(const XlsxStreamWriter &) = delete;
+    XlsxStreamWriter &operator=(const XlsxStreamWriter &) = delete;
+    ~XlsxStreamWriter();
+
+    bool open(const std::string &filename);
+
+    // Writes built sheets, ending the previous one. Their strings are added
+    // to the shared strings in order, then the XML of the sheets is made on
+    // the pool, then written one after the other
+    bool writeSheets(const std::vector<std::string> &names, const std::vector<SheetBuffer> &sheets, ThreadPool &pool);
+
+    // Ends the last sheet, writes the shared strings and the workbook parts,
+    // then moves the file in place. Returns false if it could not be written
+    bool close();
+
+private:
+    // Starts a new worksheet, ending the previous one
+    bool beginSheet(const std::string &name);
+    void endSheet();
+    void writeParts();
+    void discard();
+
+    static void appendCell(std::string &xml, int column, const std::string &rowReference, StringInterner::Symbol sharedString);
+    static std::string sheetXml(const SheetBuffer &sheet, const std::vector<StringInterner::Symbol> &sharedStringOf);
+
+    std::string filename;
+    ZipStreamWriter zip;
+
+    // Whether the temporary file exists and was not renamed yet
+    bool writing = false;
+    std::vector<std::string> sheetNames;
+    bool inSheet = false;
+
+    // The symbols of the strings are their positions in the shared strings table
+    StringInterner sharedStrings;
+    std::size_t stringReferences = 0;
+};
+
+// Column letters of a column number (ex. 1 -> "A", 28 -> "AB")
+std::string columnName(int column);
+
+// Escapes the characters that cannot appear as-is in XML text or attributes
+void appendXmlEscaped(std::string &out, std::string_view text);
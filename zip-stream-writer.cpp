@@ -0,0 +1,249 @@
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "zip-stream-writer.hpp"
+
+static const std::size_t bufferSize = 1 << 16;
+
+// The DOS date/time of the entries, fixed (1980-01-01 00:00) so that the
+// same workbook gives the same file
+static const std::uint16_t dosTime = 0;
+static const std::uint16_t dosDate = (0 << 9) | (1 << 5) | 1;
+
+static void putU16(std::string &out, std::uint16_t value)
+{
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+static void putU32(std::string &out, std::uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        out.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+std::uint32_t crc32Update(std::uint32_t crc, std::string_view data)
+{
+    static const std::array<std::uint32_t, 256> table = []
+    {
+        std::array<std::uint32_t, 256> values{};
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            std::uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            values[i] = value;
+        }
+        return values;
+    }();
+
+    crc = ~crc;
+    for (char c : data)
+    {
+        crc = table[(crc ^ static_cast<unsigned char>(c)) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+ZipStreamWriter::~ZipStreamWriter()
+{
+    if (file != nullptr)
+    {
+        std::fclose(file);
+    }
+}
+
+void ZipStreamWriter::discard()
+{
+    if (file != nullptr)
+    {
+        std::fclose(file);
+        file = nullptr;
+    }
+    buffer.clear();
+    inEntry = false;
+}
+
+bool ZipStreamWriter::open(const std::string &filename)
+{
+    file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    entries.clear();
+    inEntry = false;
+    failed = false;
+    offset = 0;
+    buffer.reserve(bufferSize);
+    return true;
+}
+
+bool ZipStreamWriter::beginEntry(const std::string &name)
+{
+    if (inEntry && !endEntry())
+    {
+        return false;
+    }
+    if (offset > UINT32_MAX)
+    {
+        failed = true;
+        return false;
+    }
+
+    entries.push_back(Entry{name, 0, 0, static_cast<std::uint32_t>(offset)});
+
+    // Local file header, the CRC-32 and sizes are written by `endEntry`
+    std::string header;
+    putU32(header, 0x04034b50);
+    putU16(header, 20); // version needed to extract (2.0)
+    putU16(header, 0);  // flags
+    putU16(header, 0);  // method: stored
+    putU16(header, dosTime);
+    putU16(header, dosDate);
+    putU32(header, 0); // CRC-32
+    putU32(header, 0); // compressed size
+    putU32(header, 0); // uncompressed size
+    putU16(header, static_cast<std::uint16_t>(name.size()));
+    putU16(header, 0); // extra field length
+    header += name;
+
+    if (std::fwrite(header.data(), 1, header.size(), file) != header.size())
+    {
+        failed = true;
+        return false;
+    }
+    offset += header.size();
+
+    inEntry = true;
+    crc = 0;
+    entrySize = 0;
+    return true;
+}
+
+void ZipStreamWriter::write(std::string_view data)
+{
+    if (buffer.size() + data.size() < bufferSize)
+    {
+        buffer.append(data);
+        return;
+    }
+
+    // Large data is written as is, not copied to the buffer
+    flush();
+    writeOut(data);
+}
+
+void ZipStreamWriter::writeOut(std::string_view data)
+{
+    crc = crc32Update(crc, data);
+    entrySize += data.size();
+    offset += data.size();
+    if (std::fwrite(data.data(), 1, data.size(), file) != data.size())
+    {
+        failed = true;
+    }
+}
+
+bool ZipStreamWriter::flush()
+{
+    if (!buffer.empty())
+    {
+        writeOut(buffer);
+        buffer.clear();
+    }
+    return !failed;
+}
+
+bool ZipStreamWriter::endEntry()
+{
+    inEntry = false;
+    if (!flush() || entrySize > UINT32_MAX)
+    {
+        failed = true;
+        return false;
+    }
+
+    Entry &entry = entries.back();
+    entry.crc = crc;
+    entry.size = static_cast<std::uint32_t>(entrySize);
+
+    // Fills in the CRC-32 and sizes of the local file header (at offset 14)
+    std::string fields;
+    putU32(fields, entry.crc);
+    putU32(fields, entry.size);
+    putU32(fields, entry.size);
+    if (std::fseek(file, static_cast<long>(entry.headerOffset + 14), SEEK_SET) != 0 ||
+        std::fwrite(fields.data(), 1, fields.size(), file) != fields.size() ||
+        std::fseek(file, 0, SEEK_END) != 0)
+    {
+        failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool ZipStreamWriter::close()
+{
+    if (file == nullptr)
+    {
+        return false;
+    }
+    if (inEntry)
+    {
+        endEntry();
+    }
+
+    // Central directory
+    std::string directory;
+    for (const auto &entry : entries)
+    {
+        putU32(directory, 0x02014b50);
+        putU16(directory, 20); // version made by
+        putU16(directory, 20); // version needed to extract
+        putU16(directory, 0);  // flags
+        putU16(directory, 0);  // method: stored
+        putU16(directory, dosTime);
+        putU16(directory, dosDate);
+        putU32(directory, entry.crc);
+        putU32(directory, entry.size);
+        putU32(directory, entry.size);
+        putU16(directory, static_cast<std::uint16_t>(entry.name.size()));
+        putU16(directory, 0); // extra field length
+        putU16(directory, 0); // comment length
+        putU16(directory, 0); // disk number
+        putU16(directory, 0); // internal attributes
+        putU32(directory, 0); // external attributes
+        putU32(directory, entry.headerOffset);
+        directory += entry.name;
+    }
+
+    // End of central directory record
+    std::string end;
+    putU32(end, 0x06054b50);
+    putU16(end, 0); // disk number
+    putU16(end, 0); // disk of the central directory
+    putU16(end, static_cast<std::uint16_t>(entries.size()));
+    putU16(end, static_cast<std::uint16_t>(entries.size()));
+    putU32(end, static_cast<std::uint32_t>(directory.size()));
+    putU32(end, static_cast<std::uint32_t>(offset));
+    putU16(end, 0); // comment length
+
+    if (offset + directory.size() > UINT32_MAX || entries.size() > UINT16_MAX ||
+        std::fwrite(directory.data(), 1, directory.size(), file) != directory.size() ||
+        std::fwrite(end.data(), 1, end.size(), file) != end.size())
+    {
+        failed = true;
+    }
+
+    bool closed = std::fclose(file) == 0;
+    file = nullptr;
+    return closed && !failed;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Writes a zip archive in one pass, entry after entry, without holding the
+// entries in memory. The entries are stored (not compressed), which every
+// xlsx reader accepts. The sizes and CRC-32 of an entry are written to its
+// header once the entry ends, so the output must be a seekable file
+//
+// No Zip64: the archive and each entry must stay under 4 GiB
+class ZipStreamWriter
+{
+public:
+    ZipStreamWriter() = default;
+    ZipStreamWriter(const ZipStreamWriter &) = delete;
+    ZipStreamWriter &operator=(const ZipStreamWriter &) = delete;
+    ~ZipStreamWriter();
+
+    bool open(const std::string &filename);
+
+    // Starts a new entry, ending the previous one
+    bool beginEntry(const std::string &name);
+
+    // Appends to the current entry
+    void write(std::string_view data);
+
+    // Ends the current entry, then writes the central directory.
+    // Returns false if anything could not be written
+    bool close();
+
+    // Closes the file as is, without the central directory (ex. after an
+    // error). The file is left to the caller to remove
+    void discard();
+
+private:
+    struct Entry
+    {
+        std::string name;
+        std::uint32_t crc;
+        std::uint32_t size;
+        std::uint32_t headerOffset;
+    };
+
+    bool endEntry();
+    void writeOut(std::string_view data);
+    bool flush();
+
+    std::FILE *file = nullptr;
+    std::vector<Entry> entries;
+    bool inEntry = false;
+    bool failed = false;
+
+    // Data of the current entry not written yet, flushed in large blocks
+    std::string buffer;
+    std::uint32_t crc = 0;
+    std::uint64_t entrySize = 0;
+    std::uint64_t offset = 0;
+};
+
+// CRC-32 (as in zip and gzip) of `data`, continuing from `crc`
+std::uint32_t crc32Update(std::uint32_t crc, std::string_view data);